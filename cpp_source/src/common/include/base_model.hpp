@@ -4,6 +4,7 @@
 #include "onnx_session.hpp"
 #include "logger.hpp"
 #include "benchmark.hpp"
+#include <algorithm>
 #include <vector>
 #include <iostream>
 
@@ -11,69 +12,138 @@ template<typename InputType, typename OutputType>
 class IBaseModel {
 public:
     IBaseModel(const std::string& model_path, int num_threads);
+    // Another inference context on an already loaded session: the weights are shared (ONNX Runtime allows
+    // concurrent Run calls on one session) while buffers and call state stay per object
+    explicit IBaseModel(std::shared_ptr<Ort::Session> session);
     virtual ~IBaseModel() = default;
     OutputType run(const InputType& input);
 
+    const std::shared_ptr<Ort::Session>& getSession() const { return session_; }
+
+    // Runs through an Ort::IoBinding with output tensors allocated once per batch size, so steady-state
+    // inference allocates no output memory. Outputs with a dynamic axis other than the batch are still
+    // allocated by ONNX Runtime on every run.
+    void setIoBinding(bool enabled);
+    bool usesIoBinding() const { return io_binding_ != nullptr; }
+
 protected:
     virtual std::vector<Ort::Value> preprocess(const InputType& input) = 0;
-    virtual std::vector<Ort::Value> infer(std::vector<Ort::Value>& input_tensors);
+    // The returned tensors are owned by the model and stay valid until the next call
+    virtual std::vector<Ort::Value>& infer(std::vector<Ort::Value>& input_tensors);
     virtual OutputType postprocess(std::vector<Ort::Value>& output_tensors) = 0;
 
-    std::unique_ptr<Ort::Session> session_;
+    std::shared_ptr<Ort::Session> session_;
     Ort::MemoryInfo memory_info_;
     std::vector<std::string> input_names_;
     std::vector<std::string> output_names_;
 
 private:
     void extractModelMetadata();
+    void bindOutputs(int64_t batch_size);
+
+    std::vector<const char*> input_names_cstr_;
+    std::vector<const char*> output_names_cstr_;
+    std::vector<std::vector<int64_t>> output_shapes_;
+    std::vector<ONNXTensorElementDataType> output_types_;
+
+    std::vector<Ort::Value> output_tensors_;
+    std::unique_ptr<Ort::IoBinding> io_binding_;
+    int64_t bound_batch_size_ = 0;  // batch size output_tensors_ were allocated for, 0 when not preallocated
+    bool outputs_preallocatable_ = true;
 };
 
 template<typename InputType, typename OutputType>
 IBaseModel<InputType, OutputType>::IBaseModel(const std::string& model_path, int num_threads)
-    : memory_info_(Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault))
+    : IBaseModel(std::shared_ptr<Ort::Session>(ONNXSessionBuilder(model_path, num_threads).build()))
+{
+}
+
+template<typename InputType, typename OutputType>
+IBaseModel<InputType, OutputType>::IBaseModel(std::shared_ptr<Ort::Session> session)
+    : session_(std::move(session)),
+      memory_info_(Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault))
 {
-    ONNXSessionBuilder builder(model_path, num_threads);
-    session_ = builder.build();
     extractModelMetadata();
 }
 
 template<typename InputType, typename OutputType>
 OutputType IBaseModel<InputType, OutputType>::run(const InputType& input) {
     std::vector<Ort::Value> input_tensors = preprocess(input);
-    std::vector<Ort::Value> output_tensors = infer(input_tensors);
+    std::vector<Ort::Value>& output_tensors = infer(input_tensors);
     return postprocess(output_tensors);
 }
 
 template<typename InputType, typename OutputType>
-std::vector<Ort::Value> IBaseModel<InputType, OutputType>::infer(std::vector<Ort::Value>& input_tensors) {
-    nl_video_analysis::ScopedTimer timer("detection_inference");
-
-    std::vector<const char*> input_names_cstr;
-    std::vector<const char*> output_names_cstr;
-
-    for (const auto& name : input_names_) {
-        input_names_cstr.push_back(name.c_str());
+void IBaseModel<InputType, OutputType>::setIoBinding(bool enabled) {
+    output_tensors_.clear();
+    bound_batch_size_ = 0;
+    io_binding_ = enabled ? std::make_unique<Ort::IoBinding>(*session_) : nullptr;
+    if (enabled && !outputs_preallocatable_) {
+        LOG_INFO("Model outputs have dynamic non-batch axes, ONNX Runtime allocates them on every run");
     }
+}
 
-    for (const auto& name : output_names_) {
-        output_names_cstr.push_back(name.c_str());
-    }
+template<typename InputType, typename OutputType>
+std::vector<Ort::Value>& IBaseModel<InputType, OutputType>::infer(std::vector<Ort::Value>& input_tensors) {
+    nl_video_analysis::ScopedTimer timer("detection_inference");
 
     try {
-        return session_->Run(
-            Ort::RunOptions{nullptr},
-            input_names_cstr.data(),
-            input_tensors.data(),
-            input_tensors.size(),
-            output_names_cstr.data(),
-            output_names_cstr.size()
-        );
+        if (!io_binding_) {
+            output_tensors_ = session_->Run(
+                Ort::RunOptions{nullptr},
+                input_names_cstr_.data(),
+                input_tensors.data(),
+                input_tensors.size(),
+                output_names_cstr_.data(),
+                output_names_cstr_.size()
+            );
+            return output_tensors_;
+        }
+
+        // Inputs are rebound every call (the caller's tensors wrap its own persistent buffers); outputs
+        // are only rebound when the batch size changes
+        for (size_t i = 0; i < input_tensors.size(); ++i) {
+            io_binding_->BindInput(input_names_cstr_[i], input_tensors[i]);
+        }
+        int64_t batch_size = input_tensors[0].GetTensorTypeAndShapeInfo().GetShape()[0];
+        if (!outputs_preallocatable_ || batch_size != bound_batch_size_) {
+            bindOutputs(batch_size);
+        }
+
+        session_->Run(Ort::RunOptions{nullptr}, *io_binding_);
+
+        if (!outputs_preallocatable_) {
+            output_tensors_ = io_binding_->GetOutputValues();
+        }
+        return output_tensors_;
     } catch (const Ort::Exception& e) {
         LOG_ERROR("ONNX Runtime inference error: {}", e.what());
         throw;
     }
 }
 
+template<typename InputType, typename OutputType>
+void IBaseModel<InputType, OutputType>::bindOutputs(int64_t batch_size) {
+    io_binding_->ClearBoundOutputs();
+    output_tensors_.clear();
+
+    if (!outputs_preallocatable_) {
+        for (const char* name : output_names_cstr_) {
+            io_binding_->BindOutput(name, memory_info_);
+        }
+        return;
+    }
+
+    Ort::AllocatorWithDefaultOptions allocator;
+    for (size_t i = 0; i < output_names_cstr_.size(); ++i) {
+        std::vector<int64_t> shape = output_shapes_[i];
+        shape[0] = batch_size;
+        output_tensors_.push_back(Ort::Value::CreateTensor(allocator, shape.data(), shape.size(), output_types_[i]));
+        io_binding_->BindOutput(output_names_cstr_[i], output_tensors_.back());
+    }
+    bound_batch_size_ = batch_size;
+}
+
 template<typename InputType, typename OutputType>
 void IBaseModel<InputType, OutputType>::extractModelMetadata() {
     Ort::AllocatorWithDefaultOptions allocator;
@@ -89,6 +159,24 @@ void IBaseModel<InputType, OutputType>::extractModelMetadata() {
     for (size_t i = 0; i < num_outputs; ++i) {
         auto output_name = session_->GetOutputNameAllocated(i, allocator);
         output_names_.push_back(output_name.get());
+
+        auto tensor_info = session_->GetOutputTypeInfo(i).GetTensorTypeAndShapeInfo();
+        output_shapes_.push_back(tensor_info.GetShape());
+        output_types_.push_back(tensor_info.GetElementType());
+
+        // Only the batch axis may be dynamic for an output to be allocated ahead of the run
+        const auto& shape = output_shapes_.back();
+        if (shape.empty() || std::any_of(shape.begin() + 1, shape.end(), [](int64_t dim) { return dim <= 0; })) {
+            outputs_preallocatable_ = false;
+        }
+    }
+
+    // Names are stable from here on, so the C strings handed to Session::Run are built once
+    for (const auto& name : input_names_) {
+        input_names_cstr_.push_back(name.c_str());
+    }
+    for (const auto& name : output_names_) {
+        output_names_cstr_.push_back(name.c_str());
     }
 }
 
@@ -7,6 +7,7 @@
 #include <vector>
 #include <algorithm>
 #include <cmath>
+#include <limits>
 
 namespace nl_video_analysis {
 
@@ -66,6 +67,12 @@ public:
         }
     }
 
+    // Record the depth of a stage's input queue (reported separately, values are item counts)
+    void recordQueueDepth(const std::string& stage_name, size_t depth) {
+        std::lock_guard<std::mutex> lock(metrics_mutex_);
+        queue_depths_[stage_name].addSample(static_cast<double>(depth));
+    }
+
     // Get metrics for a specific stage
     StageMetrics getMetrics(const std::string& stage_name, const std::string& camera_id = "") const {
         std::lock_guard<std::mutex> lock(metrics_mutex_);
@@ -84,10 +91,25 @@ public:
         return metrics_;
     }
 
+    // Drops the per-camera series of a camera that will report no more (e.g. a finished batch file); its
+    // samples stay in the global series
+    void removeCamera(const std::string& camera_id) {
+        std::lock_guard<std::mutex> lock(metrics_mutex_);
+        const std::string prefix = camera_id + ":";
+        for (auto it = metrics_.begin(); it != metrics_.end();) {
+            if (it->first.compare(0, prefix.size(), prefix) == 0) {
+                it = metrics_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
     // Reset all metrics
     void reset() {
         std::lock_guard<std::mutex> lock(metrics_mutex_);
         metrics_.clear();
+        queue_depths_.clear();
     }
 
     // Generate summary report
@@ -108,6 +130,18 @@ public:
             report += "  P99: " + std::to_string(metrics.getPercentile(0.99)) + " ms\n";
         }
 
+        if (!queue_depths_.empty()) {
+            report += "\n=== Stage Queue Depths ===\n";
+        }
+        for (const auto& [stage_name, depths] : queue_depths_) {
+            if (depths.count == 0) continue;
+
+            report += "\n" + stage_name + ":\n";
+            report += "  Average: " + std::to_string(depths.getAverage()) + "\n";
+            report += "  Max: " + std::to_string(depths.max_ms) + "\n";
+            report += "  P95: " + std::to_string(depths.getPercentile(0.95)) + "\n";
+        }
+
         return report;
     }
 
@@ -119,6 +153,7 @@ private:
 
     mutable std::mutex metrics_mutex_;
     std::unordered_map<std::string, StageMetrics> metrics_;
+    std::unordered_map<std::string, StageMetrics> queue_depths_;
 };
 
 // RAII-style timer for automatic timing
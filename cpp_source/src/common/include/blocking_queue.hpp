@@ -0,0 +1,195 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include <algorithm>
+
+namespace nl_video_analysis {
+
+enum class QueueStatus {
+    Ok,
+    Timeout,
+    Closed
+};
+
+struct QueueStats {
+    size_t depth = 0;
+    size_t capacity = 0;
+    size_t high_watermark = 0;
+    size_t pushed = 0;
+    size_t popped = 0;
+    size_t rejected = 0;              // pushes that timed out on a full queue or hit a closed one
+    double total_push_wait_ms = 0.0;  // producer time spent blocked on a full queue
+    double total_pop_wait_ms = 0.0;   // consumer time spent blocked on an empty queue
+    double total_queued_ms = 0.0;     // time popped items spent inside the queue
+
+    double getAverageQueuedMs() const {
+        return popped > 0 ? total_queued_ms / popped : 0.0;
+    }
+};
+
+// Bounded MPMC queue used between pipeline stages.
+// Producers block while the queue is full (back-pressure) and consumers block while it is empty,
+// both with an optional timeout. Once closed, pushes fail immediately and pops keep returning the
+// remaining items until the queue is drained, then report Closed.
+template<typename T>
+class BlockingQueue {
+public:
+    static constexpr std::chrono::milliseconds kWaitForever{-1};
+
+    explicit BlockingQueue(size_t capacity) : capacity_(std::max<size_t>(1, capacity)) {}
+
+    BlockingQueue(const BlockingQueue&) = delete;
+    BlockingQueue& operator=(const BlockingQueue&) = delete;
+
+    // A negative timeout waits indefinitely, zero never waits. The item is only moved from on Ok.
+    QueueStatus push(T&& item, std::chrono::milliseconds timeout = kWaitForever) {
+        auto wait_start = std::chrono::steady_clock::now();
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        auto has_room = [this] { return closed_ || items_.size() < capacity_; };
+        if (!has_room()) {
+            if (timeout.count() < 0) {
+                not_full_cv_.wait(lock, has_room);
+            } else if (!not_full_cv_.wait_for(lock, timeout, has_room)) {
+                stats_.rejected++;
+                stats_.total_push_wait_ms += elapsedMs(wait_start);
+                return QueueStatus::Timeout;
+            }
+            stats_.total_push_wait_ms += elapsedMs(wait_start);
+        }
+
+        if (closed_) {
+            stats_.rejected++;
+            return QueueStatus::Closed;
+        }
+
+        items_.emplace_back(std::move(item), std::chrono::steady_clock::now());
+        stats_.pushed++;
+        stats_.high_watermark = std::max(stats_.high_watermark, items_.size());
+        lock.unlock();
+        not_empty_cv_.notify_one();
+        return QueueStatus::Ok;
+    }
+
+    QueueStatus tryPush(T&& item) {
+        return push(std::move(item), std::chrono::milliseconds(0));
+    }
+
+    // queued_ms, when given, receives how long the popped item waited inside the queue.
+    QueueStatus pop(T& item, std::chrono::milliseconds timeout = kWaitForever, double* queued_ms = nullptr) {
+        auto wait_start = std::chrono::steady_clock::now();
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        auto has_item = [this] { return closed_ || !items_.empty(); };
+        if (!has_item()) {
+            if (timeout.count() < 0) {
+                not_empty_cv_.wait(lock, has_item);
+            } else if (!not_empty_cv_.wait_for(lock, timeout, has_item)) {
+                stats_.total_pop_wait_ms += elapsedMs(wait_start);
+                return QueueStatus::Timeout;
+            }
+            stats_.total_pop_wait_ms += elapsedMs(wait_start);
+        }
+
+        if (items_.empty()) {
+            return QueueStatus::Closed;
+        }
+
+        double item_queued_ms = elapsedMs(items_.front().second);
+        item = std::move(items_.front().first);
+        items_.pop_front();
+        stats_.popped++;
+        stats_.total_queued_ms += item_queued_ms;
+        lock.unlock();
+        not_full_cv_.notify_one();
+
+        if (queued_ms) {
+            *queued_ms = item_queued_ms;
+        }
+        return QueueStatus::Ok;
+    }
+
+    QueueStatus tryPop(T& item) {
+        return pop(item, std::chrono::milliseconds(0));
+    }
+
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+        }
+        not_empty_cv_.notify_all();
+        not_full_cv_.notify_all();
+    }
+
+    void reopen() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = false;
+    }
+
+    // Removes and returns everything still queued, e.g. to discard pending work on shutdown
+    std::vector<T> drain() {
+        std::vector<T> remaining;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            remaining.reserve(items_.size());
+            for (auto& entry : items_) {
+                remaining.push_back(std::move(entry.first));
+            }
+            items_.clear();
+        }
+        not_full_cv_.notify_all();
+        return remaining;
+    }
+
+    void setCapacity(size_t capacity) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            capacity_ = std::max<size_t>(1, capacity);
+        }
+        not_full_cv_.notify_all();
+    }
+
+    bool isClosed() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return closed_;
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return items_.size();
+    }
+
+    size_t capacity() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return capacity_;
+    }
+
+    QueueStats getStats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        QueueStats stats = stats_;
+        stats.depth = items_.size();
+        stats.capacity = capacity_;
+        return stats;
+    }
+
+private:
+    static double elapsedMs(std::chrono::steady_clock::time_point since) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+    }
+
+    mutable std::mutex mutex_;
+    std::condition_variable not_empty_cv_;
+    std::condition_variable not_full_cv_;
+    std::deque<std::pair<T, std::chrono::steady_clock::time_point>> items_;
+    size_t capacity_;
+    bool closed_ = false;
+    QueueStats stats_;
+};
+
+}
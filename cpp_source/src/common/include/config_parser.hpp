@@ -19,6 +19,7 @@ struct CameraConfig {
     std::string source_url;
     std::string source_type;  // "rtsp" or "file" so far
     StreamCodec stream_codec;
+    DecodeMode decode_mode = DecodeMode::All;
 
     CameraConfig() = default;
     CameraConfig(const std::string& id, const std::string& url, const std::string& type)
@@ -36,6 +37,19 @@ struct CameraConfig {
             this->stream_codec = StreamCodec::H264;
         }
     }
+
+    void parseDecodeMode(const std::string& mode_str)
+    {
+        if(mode_str == "nonref")
+        {
+            this->decode_mode = DecodeMode::NonReference;
+        } else if(mode_str == "keyframes") {
+            this->decode_mode = DecodeMode::Keyframes;
+        } else {
+            // Default to decoding every frame
+            this->decode_mode = DecodeMode::All;
+        }
+    }
 };
 
 struct ObjectDetectorConfig {
@@ -46,6 +60,9 @@ struct ObjectDetectorConfig {
     float nms_threshold;
     bool is_fp16;
     std::vector<int> classes;
+    int max_batch_size = 8;  // upper bound for models exported with a dynamic batch axis
+    bool class_agnostic_nms = true;
+    bool io_binding = false;  // run through Ort::IoBinding with preallocated outputs
 };
 
 struct TrackerConfig {
@@ -58,6 +75,8 @@ struct ClipImageEncoderConfig {
     std::string model_path;
     int num_threads;
     bool is_fp16;    
+    int max_batch_size = 32;  // crops per Session::Run when encoding a clip
+    bool io_binding = false;
 };
 
 struct StorageHandlerConfig {
@@ -72,11 +91,42 @@ struct StorageHandlerConfig {
 struct VideoAnalysisConfig {
     int max_connections = 10;
     int clip_length = 30;
+    int clip_stride_ms = 0;  // start a clip every stride (RTSP sources); below clip_length clips overlap, 0 keeps them disjoint
 
-    std::string sampler_type = "uniform";
+    std::string sampler_type = "uniform";  // FrameSamplerRegistry name: uniform or adaptive
     int sampled_frames_count = 5;
+    bool remux_recording = false;  // store clips from the compressed stream instead of re-encoding decoded frames
+    bool sample_at_decode = false;  // handlers only convert/keep the sampled frames; clips carry no full-rate frames
+
+    // Motion gate: clips whose sampled frames show no activity skip detection, tracking and embedding
+    bool motion_gate = false;
+    int motion_pixel_threshold = 25;             // grey-level change for a pixel to count as moving
+    double motion_min_changed_fraction = 0.002;  // changed-pixel fraction below which a clip is idle
+    bool archive_idle_clips = true;              // still store idle clips (without embeddings) instead of dropping them
+
+    int file_decode_workers = 1;      // concurrent captures per file source (offline backfills)
+    bool file_decode_ordered = true;  // hand parallel-decoded clips out in file order
 
     int queue_max_size = 100;
+    int queue_push_timeout_ms = 500;  // how long ingest waits on a full queue before dropping a clip
+
+    // Worker threads per pipeline stage; each worker owns its model sessions / trackers / DB client
+    int detection_workers = 1;
+    int tracking_workers = 1;
+    int embedding_workers = 1;
+    int storage_workers = 1;
+    int stage_queue_size = 8;  // per-worker queue capacity between stages (detection uses queue_max_size)
+
+    // Shared ONNX Runtime thread pools: every model session draws from one intra-op pool instead of
+    // spinning its own number_of_threads pool, so worker replicas do not multiply threads
+    bool ort_global_thread_pool = false;
+    int ort_intra_op_threads = 0;        // 0 = ONNX Runtime default (one per physical core)
+    int ort_inter_op_threads = 0;
+    bool ort_allow_spinning = true;
+    std::string ort_intra_op_affinity;   // ONNX Runtime affinity string, e.g. "1;2;3"
+    // Detection / embedding workers run concurrent inference contexts on one session per model instead of
+    // loading the model once per worker
+    bool share_model_sessions = false;
 
     std::vector<CameraConfig> cameras;
     ObjectDetectorConfig object_detector;
@@ -88,6 +138,8 @@ struct VideoAnalysisConfig {
     int gst_buffer_size = 5;
     int gst_drop_frames = 5;
     int gst_target_fps = 30;
+    std::string gst_decode_backend = "auto";  // auto, nvidia or software
+    int gst_decoder_threads = 0;              // software decode/convert threads per stream, 0 = all cores
     int gst_frame_width = 640;
     int gst_frame_height = 640;
 
@@ -103,6 +155,7 @@ private:
     static std::string removeQuotes(const std::string& str);
     static bool parseBool(const std::string& value);
     static int parseInt(const std::string& value);
+    static double parseDouble(const std::string& value);
     static std::string parseString(const std::string& value);
 };
 
@@ -17,13 +17,27 @@ enum class StreamCodec {
     H265
 };
 
+// How much of the stream gets decoded. Reduced modes trade temporal resolution for decode cost and
+// deliver clips with fewer frames, assembled by time instead of by frame count.
+enum class DecodeMode {
+    All,
+    NonReference,  // skip frames no other frame references (typically B-frames)
+    Keyframes      // decode only keyframes
+};
+
 struct ClipContainer {
     std::string clip_id;
     std::string camera_id;
     std::string clip_path;
 
+    // Frames are shared, not owned: they may reference decoder buffers, pooled slabs or frames of an
+    // overlapping clip. Every stage after the stream handler must treat frames and sampled_frames as
+    // read-only and copy (clone) before modifying pixels.
     std::vector<cv::Mat> frames;
+    // Headers aliasing frames[sampled_indices[i]]; no pixel data is duplicated. Clips sampled at decode time
+    // carry only sampled_frames, with frames and sampled_indices empty.
     std::vector<cv::Mat> sampled_frames;
+    std::vector<int> sampled_indices;
     uint64_t start_timestamp_ms;
     uint64_t end_timestamp_ms;
 
@@ -34,6 +48,11 @@ struct ClipContainer {
         : clip_id(clip_id), camera_id(camera_id), frames(frames),
           start_timestamp_ms(start_ts_ms), end_timestamp_ms(end_ts_ms) {}
 
+    ClipContainer(const std::string& clip_id, const std::string& camera_id,
+                  std::vector<cv::Mat>&& frames, uint64_t start_ts_ms, uint64_t end_ts_ms)
+        : clip_id(clip_id), camera_id(camera_id), frames(std::move(frames)),
+          start_timestamp_ms(start_ts_ms), end_timestamp_ms(end_ts_ms) {}
+
     ClipContainer() = default;
 };
 
@@ -45,6 +64,16 @@ class IStreamHandler {
     virtual void stopStream() = 0;
     virtual std::optional<ClipContainer> getNextClip() = 0;
     virtual bool isActive() const = 0;
+
+    // Asks the handler to materialize only the num_frames frames a uniform sampler would pick from each
+    // clip, delivering them in sampled_frames with frames left empty. Must be called before startStream().
+    // Returns false if the handler does not support it (the caller then samples the full clip itself).
+    virtual bool setDecodeSampling(int num_frames) { return false; }
+
+    // Asks the handler to record the compressed stream itself into directory (no decode/re-encode) and to
+    // reference the recording from each clip via clip_path plus "segment_offset_ms"/"segments" metadata.
+    // Must be called before startStream(). Returns false if the handler cannot record.
+    virtual bool setSegmentRecording(const std::string& directory) { return false; }
 };
 
 class IFrameSampler {
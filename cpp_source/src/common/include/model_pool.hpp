@@ -0,0 +1,123 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace nl_video_analysis {
+
+// Fixed set of inference contexts handed out to threads one at a time.
+// A model object keeps per-call state and scratch buffers, so it must only be used by one thread at a
+// time; the pool enforces that with leases. Contexts are normally built over one shared session (see
+// IBaseModel's session constructor), so N concurrent contexts cost N sets of buffers but one copy of the
+// weights.
+template<typename Model>
+class ModelPool {
+public:
+    using Factory = std::function<std::unique_ptr<Model>(size_t index)>;
+
+    // Exclusive use of one context; returns it to the pool when destroyed
+    class Lease {
+    public:
+        Lease(Lease&& other) noexcept : pool_(other.pool_), index_(other.index_) { other.pool_ = nullptr; }
+        Lease& operator=(Lease&& other) noexcept {
+            if (this != &other) {
+                release();
+                pool_ = other.pool_;
+                index_ = other.index_;
+                other.pool_ = nullptr;
+            }
+            return *this;
+        }
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        ~Lease() { release(); }
+
+        Model& operator*() const { return *pool_->contexts_[index_]; }
+        Model* operator->() const { return pool_->contexts_[index_].get(); }
+        size_t index() const { return index_; }
+
+    private:
+        friend class ModelPool;
+        Lease(ModelPool* pool, size_t index) : pool_(pool), index_(index) {}
+
+        void release() {
+            if (pool_) {
+                pool_->giveBack(index_);
+                pool_ = nullptr;
+            }
+        }
+
+        ModelPool* pool_;
+        size_t index_;
+    };
+
+    // Builds `size` contexts with `factory(i)`; at least one
+    ModelPool(size_t size, const Factory& factory) {
+        size = std::max<size_t>(1, size);
+        contexts_.reserve(size);
+        for (size_t i = 0; i < size; ++i) {
+            contexts_.push_back(factory(i));
+            free_.push_back(size - 1 - i);  // hand out context 0 first
+        }
+    }
+
+    ModelPool(const ModelPool&) = delete;
+    ModelPool& operator=(const ModelPool&) = delete;
+
+    // Blocks until a context is free
+    Lease acquire() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        available_cv_.wait(lock, [this] { return !free_.empty(); });
+        return take();
+    }
+
+    std::optional<Lease> tryAcquire() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (free_.empty()) {
+            return std::nullopt;
+        }
+        return take();
+    }
+
+    size_t size() const { return contexts_.size(); }
+
+    size_t available() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return free_.size();
+    }
+
+    // Runs `fn` on every context, e.g. to change a setting; only call while no lease is out
+    template<typename Fn>
+    void forEach(Fn&& fn) {
+        for (auto& context : contexts_) {
+            fn(*context);
+        }
+    }
+
+private:
+    Lease take() {
+        size_t index = free_.back();
+        free_.pop_back();
+        return Lease(this, index);
+    }
+
+    void giveBack(size_t index) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            free_.push_back(index);
+        }
+        available_cv_.notify_one();
+    }
+
+    std::vector<std::unique_ptr<Model>> contexts_;
+    std::vector<size_t> free_;
+    mutable std::mutex mutex_;
+    std::condition_variable available_cv_;
+};
+
+}
@@ -5,8 +5,18 @@
 #include "logger.hpp"
 #include <string>
 #include <memory>
+#include <mutex>
 #include <iostream>
 
+// Process-wide intra/inter-op thread pools shared by every session, instead of one pool per session
+struct OrtGlobalThreadPoolOptions {
+    bool enabled = false;
+    int intra_op_threads = 0;       // 0 lets ONNX Runtime pick (one per physical core)
+    int inter_op_threads = 0;       // only used by sessions in parallel execution mode
+    bool allow_spinning = true;     // idle pool threads spin before sleeping
+    std::string intra_op_affinity;  // ONNX Runtime affinity string, e.g. "1;2;3" for 4 intra-op threads
+};
+
 class ONNXSessionBuilder {
 public:
     ONNXSessionBuilder(const std::string& model_path, int num_threads);
@@ -15,7 +25,17 @@ public:
     std::unique_ptr<Ort::Session> build();
     static Ort::Env& getEnv();
 
+    // Must be called before the first session is built, as the pools live in the Ort::Env. Sessions built
+    // afterwards use the global pools and ignore their own thread count. Returns false if the Env exists.
+    static bool setGlobalThreadPool(const OrtGlobalThreadPoolOptions& options);
+    static bool usesGlobalThreadPool();
+
 private:
+    static Ort::Env createEnv();
+    static OrtGlobalThreadPoolOptions& globalThreadPoolOptions();
+    static std::mutex& envMutex();
+    static bool& envCreated();
+
     std::string model_path_;
     int num_threads_;
 
@@ -24,10 +44,63 @@ private:
 };
 
 inline Ort::Env& ONNXSessionBuilder::getEnv() {
-    static Ort::Env env(ORT_LOGGING_LEVEL_WARNING, "ONNXSession");
+    static Ort::Env env = createEnv();
     return env;
 }
 
+inline OrtGlobalThreadPoolOptions& ONNXSessionBuilder::globalThreadPoolOptions() {
+    static OrtGlobalThreadPoolOptions options;
+    return options;
+}
+
+inline std::mutex& ONNXSessionBuilder::envMutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+inline bool& ONNXSessionBuilder::envCreated() {
+    static bool created = false;
+    return created;
+}
+
+inline bool ONNXSessionBuilder::setGlobalThreadPool(const OrtGlobalThreadPoolOptions& options) {
+    std::lock_guard<std::mutex> lock(envMutex());
+    if (envCreated()) {
+        LOG_WARN("ONNX Runtime environment already exists, global thread pool settings are ignored");
+        return false;
+    }
+    globalThreadPoolOptions() = options;
+    return true;
+}
+
+inline bool ONNXSessionBuilder::usesGlobalThreadPool() {
+    getEnv();
+    std::lock_guard<std::mutex> lock(envMutex());
+    return globalThreadPoolOptions().enabled;
+}
+
+inline Ort::Env ONNXSessionBuilder::createEnv() {
+    std::lock_guard<std::mutex> lock(envMutex());
+    envCreated() = true;
+
+    const OrtGlobalThreadPoolOptions& options = globalThreadPoolOptions();
+    if (!options.enabled) {
+        return Ort::Env(ORT_LOGGING_LEVEL_WARNING, "ONNXSession");
+    }
+
+    Ort::ThreadingOptions threading;
+    threading.SetGlobalIntraOpNumThreads(options.intra_op_threads);
+    threading.SetGlobalInterOpNumThreads(options.inter_op_threads);
+    threading.SetGlobalSpinControl(options.allow_spinning ? 1 : 0);
+    if (!options.intra_op_affinity.empty()) {
+        threading.SetGlobalIntraOpThreadAffinity(options.intra_op_affinity.c_str());
+    }
+    LOG_INFO("ONNX Runtime global thread pool: {} intra-op, {} inter-op threads (0 = default), spinning {}{}",
+             options.intra_op_threads, options.inter_op_threads, options.allow_spinning ? "on" : "off",
+             options.intra_op_affinity.empty() ? "" : ", affinity " + options.intra_op_affinity);
+    return Ort::Env(threading, ORT_LOGGING_LEVEL_WARNING, "ONNXSession");
+}
+
 inline ONNXSessionBuilder::ONNXSessionBuilder(const std::string& model_path, int num_threads)
     : model_path_(model_path)
     , num_threads_(num_threads)
@@ -55,8 +128,13 @@ inline OrtCUDAProviderOptions ONNXSessionBuilder::getCUDAOptions() {
 
 inline std::unique_ptr<Ort::Session> ONNXSessionBuilder::build() {
     Ort::SessionOptions sessionOptions;
-    Ort::Env& env = getEnv();  
-    sessionOptions.SetIntraOpNumThreads(num_threads_);
+    Ort::Env& env = getEnv();
+    if (usesGlobalThreadPool()) {
+        // Threads come from the Env's global pools; num_threads_ does not apply
+        sessionOptions.DisablePerSessionThreads();
+    } else {
+        sessionOptions.SetIntraOpNumThreads(num_threads_);
+    }
     sessionOptions.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
 
     try {
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "blocking_queue.hpp"
+#include "benchmark.hpp"
+#include "logger.hpp"
+
+namespace nl_video_analysis {
+
+// A pipeline stage: N worker threads, each draining its own bounded queue.
+// Items are routed by key (the camera id in the engine) and a key always lands on the same
+// worker, so per-key ordering is preserved across stages and per-key state (e.g. trackers)
+// is only ever touched by one thread. Reports, per stage:
+//   stage_<name>_queue_wait  - time items waited in the queue (per key and global)
+//   stage_<name>_service     - time spent in the handler (per key and global)
+//   stage_<name>             - queue depth sampled on every dequeue
+template<typename T>
+class PipelineStage {
+public:
+    using Handler = std::function<void(size_t worker_index, T& item)>;
+    using KeyFunction = std::function<std::string(const T& item)>;
+    // Called with the item a handler threw on, so the owner can account for work that will never complete
+    using ErrorHandler = std::function<void(size_t worker_index, T& item, const std::exception& error)>;
+
+    PipelineStage(const std::string& name, size_t num_workers, size_t queue_capacity, KeyFunction key_fn)
+        : name_(name), key_fn_(std::move(key_fn))
+    {
+        num_workers = std::max<size_t>(1, num_workers);
+        for (size_t i = 0; i < num_workers; ++i) {
+            queues_.push_back(std::make_unique<BlockingQueue<T>>(queue_capacity));
+        }
+    }
+
+    ~PipelineStage() {
+        stop();
+    }
+
+    PipelineStage(const PipelineStage&) = delete;
+    PipelineStage& operator=(const PipelineStage&) = delete;
+
+    void start(Handler handler, ErrorHandler error_handler = nullptr) {
+        handler_ = std::move(handler);
+        error_handler_ = std::move(error_handler);
+        for (size_t i = 0; i < queues_.size(); ++i) {
+            queues_[i]->reopen();
+            threads_.emplace_back(&PipelineStage::workerLoop, this, i);
+        }
+    }
+
+    // Closes the queues, discards whatever is still pending and waits for in-flight items.
+    // Returns the number of discarded items.
+    size_t stop() {
+        size_t discarded = 0;
+        for (auto& queue : queues_) {
+            queue->close();
+            discarded += queue->drain().size();
+        }
+        for (auto& thread : threads_) {
+            if (thread.joinable()) {
+                thread.join();
+            }
+        }
+        threads_.clear();
+        return discarded;
+    }
+
+    QueueStatus submit(T&& item, std::chrono::milliseconds timeout = BlockingQueue<T>::kWaitForever) {
+        return queues_[workerFor(key_fn_(item))]->push(std::move(item), timeout);
+    }
+
+    bool tryTake(T& item) {
+        for (auto& queue : queues_) {
+            if (queue->tryPop(item) == QueueStatus::Ok) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Drops the routing of a key that will send no more items (e.g. a finished batch file); a key seen again
+    // afterwards is routed afresh. The key's last item may still be in its handler.
+    void forget(const std::string& key) {
+        std::lock_guard<std::mutex> lock(routing_mutex_);
+        routing_.erase(key);
+    }
+
+    const std::string& getName() const { return name_; }
+    size_t getNumWorkers() const { return queues_.size(); }
+
+    size_t getQueueSize() const {
+        size_t total = 0;
+        for (const auto& queue : queues_) {
+            total += queue->size();
+        }
+        return total;
+    }
+
+    std::vector<QueueStats> getQueueStats() const {
+        std::vector<QueueStats> stats;
+        for (const auto& queue : queues_) {
+            stats.push_back(queue->getStats());
+        }
+        return stats;
+    }
+
+private:
+    size_t workerFor(const std::string& key) {
+        std::lock_guard<std::mutex> lock(routing_mutex_);
+        auto it = routing_.find(key);
+        if (it == routing_.end()) {
+            it = routing_.emplace(key, next_worker_++ % queues_.size()).first;
+        }
+        return it->second;
+    }
+
+    bool isRouted(const std::string& key) {
+        std::lock_guard<std::mutex> lock(routing_mutex_);
+        return routing_.count(key) > 0;
+    }
+
+    void workerLoop(size_t worker_index) {
+        BlockingQueue<T>& queue = *queues_[worker_index];
+        const std::string queue_wait_stage = "stage_" + name_ + "_queue_wait";
+        const std::string service_stage = "stage_" + name_ + "_service";
+
+        T item;
+        double queued_ms = 0.0;
+        while (queue.pop(item, BlockingQueue<T>::kWaitForever, &queued_ms) == QueueStatus::Ok) {
+            std::string key = key_fn_(item);
+            PipelineBenchmark::getInstance().recordTiming(queue_wait_stage, queued_ms, key);
+            PipelineBenchmark::getInstance().recordQueueDepth(name_, queue.size());
+
+            auto start = std::chrono::steady_clock::now();
+            try {
+                handler_(worker_index, item);
+            } catch (const std::exception& e) {
+                LOG_ERROR("[{}] worker {} failed on item from '{}': {}", name_, worker_index, key, e.what());
+                if (error_handler_) {
+                    error_handler_(worker_index, item, e);
+                }
+            }
+            double service_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            // A key forgotten while its last item was handled only adds to the global series
+            PipelineBenchmark::getInstance().recordTiming(service_stage, service_ms, isRouted(key) ? key : "");
+        }
+    }
+
+    std::string name_;
+    KeyFunction key_fn_;
+    Handler handler_;
+    ErrorHandler error_handler_;
+    std::vector<std::unique_ptr<BlockingQueue<T>>> queues_;
+    std::vector<std::thread> threads_;
+
+    std::mutex routing_mutex_;
+    std::unordered_map<std::string, size_t> routing_;
+    size_t next_worker_ = 0;
+};
+
+}
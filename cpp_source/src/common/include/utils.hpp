@@ -47,6 +47,47 @@ inline std::optional<cv::Mat> crop_object(const cv::Mat& frame,
     return cropped;
 }
 
+// Indices of num_frames frames spread evenly over [0, total_frames), first and last included.
+// Shared by the frame samplers and the stream handlers that sample at decode time, so both pick the same frames.
+inline std::vector<int> uniformSampleIndices(int total_frames, int num_frames) {
+    std::vector<int> indices;
+    if (total_frames <= 0 || num_frames <= 0) {
+        return indices;
+    }
+
+    num_frames = std::min(num_frames, total_frames);
+    indices.reserve(num_frames);
+    if (num_frames == 1) {
+        indices.push_back(total_frames / 2);
+    } else {
+        double step = static_cast<double>(total_frames - 1) / (num_frames - 1);
+        for (int i = 0; i < num_frames; ++i) {
+            indices.push_back(static_cast<int>(i * step));
+        }
+    }
+    return indices;
+}
+
+// Blurred grayscale copy of a frame scaled to `width` (aspect kept), for cheap activity analysis. The blur
+// suppresses sensor noise and compression artefacts that would otherwise register as change.
+inline cv::Mat downscaledGray(const cv::Mat& frame, int width, int blur_kernel = 5) {
+    int height = std::max(1, frame.rows * width / std::max(1, frame.cols));
+
+    cv::Mat small;
+    cv::resize(frame, small, cv::Size(width, height), 0, 0, cv::INTER_AREA);
+
+    cv::Mat gray;
+    if (small.channels() == 3) {
+        cv::cvtColor(small, gray, cv::COLOR_BGR2GRAY);
+    } else {
+        gray = small;
+    }
+    if (blur_kernel > 1) {
+        cv::GaussianBlur(gray, gray, cv::Size(blur_kernel, blur_kernel), 0);
+    }
+    return gray;
+}
+
 inline std::vector<float> averageTrackEmbeddings(const std::vector<std::vector<float>>& track_embeddings) {
     if (track_embeddings.empty()) {
         return std::vector<float>();
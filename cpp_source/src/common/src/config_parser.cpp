@@ -96,6 +96,12 @@ VideoAnalysisConfig ConfigParser::parseFromFile(const std::string& filepath) {
                         std::string stream_codec = parseString(line.substr(colon + 1));
                         current_camera.parseCodec(stream_codec);
                     }
+                } else if (line.find("\"decode_mode\"") != std::string::npos) {
+                    size_t colon = line.find(':');
+                    if (colon != std::string::npos) {
+                        std::string decode_mode = parseString(line.substr(colon + 1));
+                        current_camera.parseDecodeMode(decode_mode);
+                    }
                 }
             }
             continue;
@@ -188,6 +194,21 @@ VideoAnalysisConfig ConfigParser::parseFromFile(const std::string& filepath) {
                 if (colon != std::string::npos) {
                     config.object_detector.is_fp16 = parseBool(line.substr(colon + 1));
                 }
+            } else if (line.find("\"max_batch_size\"") != std::string::npos) {
+                size_t colon = line.find(':');
+                if (colon != std::string::npos) {
+                    config.object_detector.max_batch_size = parseInt(line.substr(colon + 1));
+                }
+            } else if (line.find("\"class_agnostic_nms\"") != std::string::npos) {
+                size_t colon = line.find(':');
+                if (colon != std::string::npos) {
+                    config.object_detector.class_agnostic_nms = parseBool(line.substr(colon + 1));
+                }
+            } else if (line.find("\"io_binding\"") != std::string::npos) {
+                size_t colon = line.find(':');
+                if (colon != std::string::npos) {
+                    config.object_detector.io_binding = parseBool(line.substr(colon + 1));
+                }
             }
             continue;
         }
@@ -219,6 +240,11 @@ VideoAnalysisConfig ConfigParser::parseFromFile(const std::string& filepath) {
         }
         if(in_image_encoder_object)
         {
+            if (line.find('}') != std::string::npos) {
+                in_image_encoder_object = false;
+                continue;
+            }
+
             if (line.find("\"model_path\"") != std::string::npos) {
                 size_t colon = line.find(':');
                 if (colon != std::string::npos) {
@@ -234,7 +260,18 @@ VideoAnalysisConfig ConfigParser::parseFromFile(const std::string& filepath) {
                 if (colon != std::string::npos) {
                     config.image_encoder.is_fp16 = parseBool(line.substr(colon + 1));
                 }
+            } else if (line.find("\"max_batch_size\"") != std::string::npos) {
+                size_t colon = line.find(':');
+                if (colon != std::string::npos) {
+                    config.image_encoder.max_batch_size = parseInt(line.substr(colon + 1));
+                }
+            } else if (line.find("\"io_binding\"") != std::string::npos) {
+                size_t colon = line.find(':');
+                if (colon != std::string::npos) {
+                    config.image_encoder.io_binding = parseBool(line.substr(colon + 1));
+                }
             }
+            continue;
         }
 
         if(in_storage_handler_object)
@@ -286,18 +323,64 @@ VideoAnalysisConfig ConfigParser::parseFromFile(const std::string& filepath) {
             config.max_connections = parseInt(value);
         } else if (key == "clip_length") {
             config.clip_length = parseInt(value);
+        } else if (key == "clip_stride_ms") {
+            config.clip_stride_ms = parseInt(value);
         } else if (key == "sampler_type") {
             config.sampler_type = parseString(value);
         } else if (key == "sampled_frames_count") {
             config.sampled_frames_count = parseInt(value);
+        } else if (key == "remux_recording") {
+            config.remux_recording = parseBool(value);
+        } else if (key == "sample_at_decode") {
+            config.sample_at_decode = parseBool(value);
+        } else if (key == "motion_gate") {
+            config.motion_gate = parseBool(value);
+        } else if (key == "motion_pixel_threshold") {
+            config.motion_pixel_threshold = parseInt(value);
+        } else if (key == "motion_min_changed_fraction") {
+            config.motion_min_changed_fraction = parseDouble(value);
+        } else if (key == "archive_idle_clips") {
+            config.archive_idle_clips = parseBool(value);
+        } else if (key == "file_decode_workers") {
+            config.file_decode_workers = parseInt(value);
+        } else if (key == "file_decode_ordered") {
+            config.file_decode_ordered = parseBool(value);
         } else if (key == "queue_max_size") {
             config.queue_max_size = parseInt(value);
+        } else if (key == "queue_push_timeout_ms") {
+            config.queue_push_timeout_ms = parseInt(value);
+        } else if (key == "detection_workers") {
+            config.detection_workers = parseInt(value);
+        } else if (key == "tracking_workers") {
+            config.tracking_workers = parseInt(value);
+        } else if (key == "embedding_workers") {
+            config.embedding_workers = parseInt(value);
+        } else if (key == "storage_workers") {
+            config.storage_workers = parseInt(value);
+        } else if (key == "stage_queue_size") {
+            config.stage_queue_size = parseInt(value);
+        } else if (key == "ort_global_thread_pool") {
+            config.ort_global_thread_pool = parseBool(value);
+        } else if (key == "ort_intra_op_threads") {
+            config.ort_intra_op_threads = parseInt(value);
+        } else if (key == "ort_inter_op_threads") {
+            config.ort_inter_op_threads = parseInt(value);
+        } else if (key == "ort_allow_spinning") {
+            config.ort_allow_spinning = parseBool(value);
+        } else if (key == "ort_intra_op_affinity") {
+            config.ort_intra_op_affinity = parseString(value);
+        } else if (key == "share_model_sessions") {
+            config.share_model_sessions = parseBool(value);
         } else if (key == "gst_buffer_size") {
             config.gst_buffer_size = parseInt(value);
         } else if (key == "gst_drop_frames") {
             config.gst_drop_frames = parseInt(value);
         } else if (key == "gst_target_fps") {
             config.gst_target_fps = parseInt(value);
+        } else if (key == "gst_decode_backend") {
+            config.gst_decode_backend = parseString(value);
+        } else if (key == "gst_decoder_threads") {
+            config.gst_decoder_threads = parseInt(value);
         } else if (key == "gst_frame_width") {
             config.gst_frame_width = parseInt(value);
         } else if (key == "gst_frame_height") {
@@ -335,6 +418,10 @@ int ConfigParser::parseInt(const std::string& value) {
     return std::stoi(trim(value));
 }
 
+double ConfigParser::parseDouble(const std::string& value) {
+    return std::stod(trim(value));
+}
+
 std::string ConfigParser::parseString(const std::string& value) {
     return removeQuotes(value);
 }
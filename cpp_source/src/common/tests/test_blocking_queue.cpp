@@ -0,0 +1,181 @@
+#define CATCH_CONFIG_MAIN
+#include "../../../lib/catch2/catch_amalgamated.hpp"
+#include "blocking_queue.hpp"
+#include <atomic>
+#include <thread>
+
+using namespace nl_video_analysis;
+using namespace std::chrono_literals;
+
+TEST_CASE("BlockingQueue push and pop", "[blocking_queue]") {
+    BlockingQueue<int> queue(2);
+
+    REQUIRE(queue.push(1) == QueueStatus::Ok);
+    REQUIRE(queue.tryPush(2) == QueueStatus::Ok);
+    REQUIRE(queue.size() == 2);
+
+    SECTION("Items come out in order") {
+        int item = 0;
+        REQUIRE(queue.pop(item) == QueueStatus::Ok);
+        REQUIRE(item == 1);
+        REQUIRE(queue.tryPop(item) == QueueStatus::Ok);
+        REQUIRE(item == 2);
+    }
+
+    SECTION("Push times out on a full queue and leaves the item alone") {
+        std::vector<int> item = {3};
+        BlockingQueue<std::vector<int>> full(1);
+        REQUIRE(full.push({1}) == QueueStatus::Ok);
+        REQUIRE(full.push(std::move(item), 20ms) == QueueStatus::Timeout);
+        REQUIRE(item == std::vector<int>{3});
+        REQUIRE(full.tryPush(std::move(item)) == QueueStatus::Timeout);
+        REQUIRE(full.size() == 1);
+
+        REQUIRE(queue.tryPush(3) == QueueStatus::Timeout);
+    }
+
+    SECTION("Pop times out on an empty queue") {
+        int item = 0;
+        queue.drain();
+        auto start = std::chrono::steady_clock::now();
+        REQUIRE(queue.pop(item, 20ms) == QueueStatus::Timeout);
+        REQUIRE(std::chrono::steady_clock::now() - start >= 20ms);
+        REQUIRE(queue.tryPop(item) == QueueStatus::Timeout);
+    }
+
+    SECTION("A blocked producer resumes once there is room") {
+        std::atomic<bool> pushed{false};
+        QueueStatus status = QueueStatus::Closed;
+        std::thread producer([&] {
+            status = queue.push(3);
+            pushed = true;
+        });
+        std::this_thread::sleep_for(20ms);
+        REQUIRE_FALSE(pushed);
+
+        int item = 0;
+        REQUIRE(queue.pop(item) == QueueStatus::Ok);
+        producer.join();
+        REQUIRE(status == QueueStatus::Ok);
+        REQUIRE(queue.size() == 2);
+    }
+}
+
+TEST_CASE("BlockingQueue close", "[blocking_queue]") {
+    SECTION("Wakes a blocked consumer") {
+        BlockingQueue<int> queue(1);
+        QueueStatus status = QueueStatus::Ok;
+        std::thread consumer([&] {
+            int item = 0;
+            status = queue.pop(item);
+        });
+        std::this_thread::sleep_for(20ms);
+        queue.close();
+        consumer.join();
+        REQUIRE(status == QueueStatus::Closed);
+    }
+
+    SECTION("Wakes a blocked producer") {
+        BlockingQueue<int> queue(1);
+        REQUIRE(queue.push(1) == QueueStatus::Ok);
+        QueueStatus status = QueueStatus::Ok;
+        std::thread producer([&] { status = queue.push(2); });
+        std::this_thread::sleep_for(20ms);
+        queue.close();
+        producer.join();
+        REQUIRE(status == QueueStatus::Closed);
+    }
+
+    SECTION("Pops the remaining items before reporting Closed") {
+        BlockingQueue<int> queue(4);
+        queue.push(1);
+        queue.push(2);
+        queue.close();
+        REQUIRE(queue.isClosed());
+        REQUIRE(queue.push(3) == QueueStatus::Closed);
+
+        int item = 0;
+        REQUIRE(queue.pop(item) == QueueStatus::Ok);
+        REQUIRE(item == 1);
+        REQUIRE(queue.pop(item) == QueueStatus::Ok);
+        REQUIRE(item == 2);
+        REQUIRE(queue.pop(item) == QueueStatus::Closed);
+    }
+}
+
+TEST_CASE("BlockingQueue drain and reopen", "[blocking_queue]") {
+    BlockingQueue<int> queue(4);
+    queue.push(1);
+    queue.push(2);
+    queue.push(3);
+    queue.close();
+
+    REQUIRE(queue.drain() == std::vector<int>{1, 2, 3});
+    REQUIRE(queue.size() == 0);
+    REQUIRE(queue.drain().empty());
+
+    queue.reopen();
+    REQUIRE_FALSE(queue.isClosed());
+    REQUIRE(queue.push(4) == QueueStatus::Ok);
+    int item = 0;
+    REQUIRE(queue.pop(item) == QueueStatus::Ok);
+    REQUIRE(item == 4);
+}
+
+TEST_CASE("BlockingQueue drain makes room for a blocked producer", "[blocking_queue]") {
+    BlockingQueue<int> queue(1);
+    queue.push(1);
+    QueueStatus status = QueueStatus::Closed;
+    std::thread producer([&] { status = queue.push(2); });
+    std::this_thread::sleep_for(20ms);
+
+    std::vector<int> drained = queue.drain();
+    producer.join();
+    REQUIRE(status == QueueStatus::Ok);
+    REQUIRE(drained == std::vector<int>{1});
+    REQUIRE(queue.size() == 1);
+}
+
+TEST_CASE("BlockingQueue stats", "[blocking_queue]") {
+    BlockingQueue<int> queue(2);
+    queue.push(1);
+    queue.push(2);
+    REQUIRE(queue.push(3, 10ms) == QueueStatus::Timeout);
+
+    std::this_thread::sleep_for(10ms);
+    int item = 0;
+    double queued_ms = 0.0;
+    REQUIRE(queue.pop(item, BlockingQueue<int>::kWaitForever, &queued_ms) == QueueStatus::Ok);
+    REQUIRE(queued_ms >= 10.0);
+    REQUIRE(queue.pop(item, 10ms) == QueueStatus::Ok);
+    REQUIRE(queue.pop(item, 10ms) == QueueStatus::Timeout);
+
+    queue.close();
+    REQUIRE(queue.push(4) == QueueStatus::Closed);
+
+    QueueStats stats = queue.getStats();
+    REQUIRE(stats.depth == 0);
+    REQUIRE(stats.capacity == 2);
+    REQUIRE(stats.high_watermark == 2);
+    REQUIRE(stats.pushed == 2);
+    REQUIRE(stats.popped == 2);
+    REQUIRE(stats.rejected == 2);  // the timed-out push and the push after close
+    REQUIRE(stats.total_push_wait_ms >= 10.0);
+    REQUIRE(stats.total_pop_wait_ms >= 10.0);
+    REQUIRE(stats.total_queued_ms >= queued_ms);
+    REQUIRE(stats.getAverageQueuedMs() == Catch::Approx(stats.total_queued_ms / 2));
+}
+
+TEST_CASE("BlockingQueue setCapacity", "[blocking_queue]") {
+    BlockingQueue<int> queue(0);
+    REQUIRE(queue.capacity() == 1);
+
+    queue.push(1);
+    QueueStatus status = QueueStatus::Closed;
+    std::thread producer([&] { status = queue.push(2); });
+    std::this_thread::sleep_for(20ms);
+    queue.setCapacity(2);
+    producer.join();
+    REQUIRE(status == QueueStatus::Ok);
+    REQUIRE(queue.size() == 2);
+}
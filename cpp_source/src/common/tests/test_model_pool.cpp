@@ -0,0 +1,132 @@
+#define CATCH_CONFIG_MAIN
+#include "../../../lib/catch2/catch_amalgamated.hpp"
+#include "model_pool.hpp"
+#include <atomic>
+#include <set>
+#include <thread>
+
+using namespace nl_video_analysis;
+using namespace std::chrono_literals;
+
+struct FakeModel {
+    size_t id;
+    int calls = 0;
+};
+
+static ModelPool<FakeModel>::Factory fakeFactory() {
+    return [](size_t index) { return std::make_unique<FakeModel>(FakeModel{index}); };
+}
+
+TEST_CASE("ModelPool builds at least one context", "[model_pool]") {
+    ModelPool<FakeModel> pool(0, fakeFactory());
+    REQUIRE(pool.size() == 1);
+    REQUIRE(pool.available() == 1);
+}
+
+TEST_CASE("ModelPool leases are exclusive", "[model_pool]") {
+    ModelPool<FakeModel> pool(2, fakeFactory());
+
+    auto first = pool.acquire();
+    auto second = pool.acquire();
+    REQUIRE(first.index() != second.index());
+    REQUIRE(first->id == first.index());
+    REQUIRE((*second).id == second.index());
+    REQUIRE(pool.available() == 0);
+
+    SECTION("tryAcquire returns nullopt while every context is leased") {
+        REQUIRE_FALSE(pool.tryAcquire().has_value());
+    }
+
+    SECTION("acquire blocks until a lease is returned") {
+        std::atomic<bool> acquired{false};
+        size_t acquired_index = pool.size();
+        std::thread waiter([&] {
+            auto lease = pool.acquire();
+            acquired_index = lease.index();
+            acquired = true;
+        });
+
+        std::this_thread::sleep_for(30ms);
+        REQUIRE_FALSE(acquired);
+
+        size_t returned_index = first.index();
+        { auto released = std::move(first); }
+        waiter.join();
+        REQUIRE(acquired);
+        REQUIRE(acquired_index == returned_index);
+    }
+}
+
+TEST_CASE("ModelPool lease moves release once", "[model_pool]") {
+    ModelPool<FakeModel> pool(3, fakeFactory());
+
+    SECTION("Move construction") {
+        {
+            auto lease = pool.acquire();
+            auto moved = std::move(lease);
+            REQUIRE(pool.available() == 2);
+        }
+        REQUIRE(pool.available() == 3);
+    }
+
+    SECTION("Move assignment returns the overwritten lease") {
+        {
+            auto a = pool.acquire();
+            auto b = pool.acquire();
+            REQUIRE(pool.available() == 1);
+            a = std::move(b);
+            REQUIRE(pool.available() == 2);
+        }
+        REQUIRE(pool.available() == 3);
+    }
+
+    SECTION("A lease moved into an optional") {
+        {
+            std::optional<ModelPool<FakeModel>::Lease> lease = pool.tryAcquire();
+            REQUIRE(lease.has_value());
+            REQUIRE(pool.available() == 2);
+        }
+        REQUIRE(pool.available() == 3);
+    }
+
+    // The free list holds every context exactly once again
+    std::set<size_t> indices;
+    std::vector<ModelPool<FakeModel>::Lease> leases;
+    for (size_t i = 0; i < pool.size(); ++i) {
+        leases.push_back(pool.acquire());
+        indices.insert(leases.back().index());
+    }
+    REQUIRE(indices == std::set<size_t>{0, 1, 2});
+    REQUIRE_FALSE(pool.tryAcquire().has_value());
+}
+
+TEST_CASE("ModelPool under concurrent leases", "[model_pool]") {
+    ModelPool<FakeModel> pool(2, fakeFactory());
+    std::atomic<int> in_use{0};
+    std::atomic<int> max_in_use{0};
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < 200; ++i) {
+                auto lease = pool.acquire();
+                int now = ++in_use;
+                max_in_use = std::max(max_in_use.load(), now);
+                // Unsynchronized on purpose: a context handed to two threads at once would race here
+                int calls = lease->calls;
+                std::this_thread::yield();
+                lease->calls = calls + 1;
+                --in_use;
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    int total_calls = 0;
+    pool.forEach([&](FakeModel& model) { total_calls += model.calls; });
+    REQUIRE(total_calls == 8 * 200);
+    REQUIRE(max_in_use <= 2);
+    REQUIRE(pool.available() == 2);
+}
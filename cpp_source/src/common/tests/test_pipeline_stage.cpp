@@ -0,0 +1,182 @@
+#define CATCH_CONFIG_MAIN
+#include "../../../lib/catch2/catch_amalgamated.hpp"
+#include "pipeline_stage.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <set>
+#include <stdexcept>
+
+using namespace nl_video_analysis;
+using namespace std::chrono_literals;
+
+struct TestItem {
+    std::string key;
+    int sequence = 0;
+};
+
+static PipelineStage<TestItem>::KeyFunction byKey() {
+    return [](const TestItem& item) { return item.key; };
+}
+
+// Polls until `done` holds, so tests never hang on a broken stage
+template<typename Predicate>
+static bool waitFor(Predicate done, std::chrono::milliseconds timeout = 5000ms) {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!done()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(1ms);
+    }
+    return true;
+}
+
+TEST_CASE("PipelineStage routes a key to one worker in order", "[pipeline_stage]") {
+    PipelineStage<TestItem> stage("test_routing", 3, 4, byKey());
+    REQUIRE(stage.getNumWorkers() == 3);
+
+    std::mutex mutex;
+    std::map<std::string, std::vector<std::pair<size_t, int>>> handled;  // key -> (worker, sequence)
+    std::atomic<size_t> count{0};
+    stage.start([&](size_t worker_index, TestItem& item) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            handled[item.key].emplace_back(worker_index, item.sequence);
+        }
+        count++;
+    });
+
+    const std::vector<std::string> keys = {"cam_a", "cam_b", "cam_c", "cam_d", "cam_e"};
+    const int per_key = 40;
+    for (int i = 0; i < per_key; ++i) {
+        for (const auto& key : keys) {
+            REQUIRE(stage.submit({key, i}) == QueueStatus::Ok);
+        }
+    }
+
+    REQUIRE(waitFor([&] { return count == keys.size() * per_key; }));
+    REQUIRE(stage.stop() == 0);
+
+    std::set<size_t> workers_used;
+    for (const auto& key : keys) {
+        const auto& items = handled[key];
+        REQUIRE(items.size() == per_key);
+        for (int i = 0; i < per_key; ++i) {
+            REQUIRE(items[i].first == items[0].first);
+            REQUIRE(items[i].second == i);
+        }
+        workers_used.insert(items[0].first);
+    }
+    // Keys are spread round-robin over the workers
+    REQUIRE(workers_used.size() == 3);
+}
+
+TEST_CASE("PipelineStage reports a throwing handler's item and keeps going", "[pipeline_stage]") {
+    PipelineStage<TestItem> stage("test_errors", 1, 8, byKey());
+
+    std::mutex mutex;
+    std::vector<int> handled;
+    std::vector<std::pair<int, std::string>> failed;  // sequence, error message
+    std::atomic<size_t> count{0};
+    stage.start(
+        [&](size_t, TestItem& item) {
+            if (item.sequence % 2 == 1) {
+                throw std::runtime_error("bad item " + std::to_string(item.sequence));
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            handled.push_back(item.sequence);
+            count++;
+        },
+        [&](size_t worker_index, TestItem& item, const std::exception& error) {
+            std::lock_guard<std::mutex> lock(mutex);
+            failed.emplace_back(item.sequence, error.what());
+            count++;
+        });
+
+    for (int i = 0; i < 6; ++i) {
+        REQUIRE(stage.submit({"cam", i}) == QueueStatus::Ok);
+    }
+    REQUIRE(waitFor([&] { return count == 6; }));
+    stage.stop();
+
+    REQUIRE(handled == std::vector<int>{0, 2, 4});
+    REQUIRE(failed.size() == 3);
+    REQUIRE(failed[0] == std::make_pair(1, std::string("bad item 1")));
+    REQUIRE(failed[2] == std::make_pair(5, std::string("bad item 5")));
+}
+
+TEST_CASE("PipelineStage stop discards pending items and joins the workers", "[pipeline_stage]") {
+    PipelineStage<TestItem> stage("test_stop", 1, 8, byKey());
+
+    std::mutex mutex;
+    std::condition_variable release_cv;
+    bool release = false;
+    std::atomic<bool> started{false};
+    std::atomic<size_t> finished{0};
+    stage.start([&](size_t, TestItem&) {
+        started = true;
+        std::unique_lock<std::mutex> lock(mutex);
+        release_cv.wait(lock, [&] { return release; });
+        finished++;
+    });
+
+    for (int i = 0; i < 4; ++i) {
+        REQUIRE(stage.submit({"cam", i}) == QueueStatus::Ok);
+    }
+    REQUIRE(waitFor([&] { return started.load(); }));
+
+    // The first item is in the handler; stop() must wait for it while the other three are discarded
+    std::thread releaser([&] {
+        std::this_thread::sleep_for(20ms);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            release = true;
+        }
+        release_cv.notify_all();
+    });
+    size_t discarded = stage.stop();
+    size_t finished_at_stop = finished;
+    releaser.join();
+
+    REQUIRE(discarded == 3);
+    REQUIRE(finished_at_stop == 1);
+    REQUIRE(stage.getQueueSize() == 0);
+    REQUIRE(stage.submit({"cam", 4}) == QueueStatus::Closed);
+
+    SECTION("A stopped stage can be started again") {
+        stage.start([&](size_t, TestItem&) { finished++; });
+        REQUIRE(stage.submit({"cam", 5}) == QueueStatus::Ok);
+        REQUIRE(waitFor([&] { return finished == 2; }));
+        REQUIRE(stage.stop() == 0);
+    }
+}
+
+TEST_CASE("PipelineStage forgets a key", "[pipeline_stage]") {
+    PipelineBenchmark::getInstance().reset();
+    PipelineStage<TestItem> stage("test_forget", 2, 4, byKey());
+
+    std::atomic<size_t> count{0};
+    stage.start([&](size_t, TestItem& item) {
+        if (item.sequence == 1) {
+            // The key's last item: its owner forgets the key from inside the handler
+            stage.forget(item.key);
+        }
+        count++;
+    });
+
+    REQUIRE(stage.submit({"file.mp4", 0}) == QueueStatus::Ok);
+    REQUIRE(stage.submit({"file.mp4", 1}) == QueueStatus::Ok);
+    REQUIRE(waitFor([&] { return count == 2; }));
+    stage.stop();
+
+    // Only the first item adds to the key's series; both add to the global one
+    auto& benchmark = PipelineBenchmark::getInstance();
+    REQUIRE(benchmark.getMetrics("stage_test_forget_service", "file.mp4").count == 1);
+    REQUIRE(benchmark.getMetrics("stage_test_forget_service").count == 2);
+
+    benchmark.removeCamera("file.mp4");
+    REQUIRE(benchmark.getMetrics("stage_test_forget_service", "file.mp4").count == 0);
+    REQUIRE(benchmark.getMetrics("stage_test_forget_queue_wait", "file.mp4").count == 0);
+    REQUIRE(benchmark.getMetrics("stage_test_forget_queue_wait").count == 2);
+}
@@ -2,6 +2,10 @@
 
 #include "../../../common/include/interfaces.hpp"
 #include <algorithm>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <random>
 #include <iostream>
 
@@ -12,4 +16,42 @@ public:
     UniformFrameSampler() = default;
     void sampleFrames(ClipContainer& clip, int num_frames) override;
 };
-}
\ No newline at end of file
+
+// Picks the frames where the scene changes most. Every frame is scored by its mean absolute difference to the
+// previous frame on a small blurred grayscale copy; the highest-scoring frames are taken, at least
+// total/(2*num_frames) frames apart so one event does not use up the budget. Clips whose strongest change stays
+// below min_activity (grey levels) and slots left unfilled after the spacing rule fall back to uniform sampling.
+class AdaptiveFrameSampler : public IFrameSampler {
+public:
+    AdaptiveFrameSampler(double min_activity = 1.0, int analysis_width = 64);
+    void sampleFrames(ClipContainer& clip, int num_frames) override;
+
+    // Exposed for tests: per-frame change scores and the indices the sampler would pick
+    std::vector<double> scoreFrames(const std::vector<cv::Mat>& frames) const;
+    std::vector<int> selectIndices(const std::vector<double>& scores, int num_frames) const;
+
+private:
+    double min_activity_;
+    int analysis_width_;
+};
+
+using FrameSamplerFactory = std::function<std::unique_ptr<IFrameSampler>()>;
+
+// Maps `sampler_type` names to sampler factories. "uniform" and "adaptive" are built in; other samplers can
+// register themselves before the engine is constructed.
+class FrameSamplerRegistry {
+public:
+    static FrameSamplerRegistry& getInstance();
+
+    void registerSampler(const std::string& type, FrameSamplerFactory factory);
+    // nullptr for an unknown type
+    std::unique_ptr<IFrameSampler> create(const std::string& type) const;
+    std::vector<std::string> getTypes() const;
+
+private:
+    FrameSamplerRegistry();
+
+    mutable std::mutex mutex_;
+    std::map<std::string, FrameSamplerFactory> factories_;
+};
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "../../../common/include/interfaces.hpp"
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <opencv2/opencv.hpp>
+
+namespace nl_video_analysis {
+
+struct MotionGateResult {
+    double activity = 0.0;  // largest fraction of changed pixels between consecutive sampled frames
+    bool idle = true;
+};
+
+// Cheap activity check on a clip's sampled frames, run before detection so clips of static scenes can skip
+// the detector and the image encoder. Frames are downscaled to analysis_width, converted to blurred
+// grayscale and differenced pairwise; a pixel counts as changed when it moves by more than pixel_threshold
+// grey levels. The last analysed frame of every camera is kept, so motion across a clip boundary (or in a
+// clip with a single sampled frame) is still seen.
+//
+// Thread-safe: ingest threads of different cameras share one gate.
+class MotionGate {
+public:
+    MotionGate(int pixel_threshold = 25, double min_changed_fraction = 0.002, int analysis_width = 160);
+
+    MotionGateResult evaluate(const ClipContainer& clip);
+
+    // Forgets a camera's reference frame (e.g. when its stream restarts)
+    void reset(const std::string& camera_id);
+
+private:
+    cv::Mat prepare(const cv::Mat& frame) const;
+    double changedFraction(const cv::Mat& previous, const cv::Mat& current) const;
+
+    int pixel_threshold_;
+    double min_changed_fraction_;
+    int analysis_width_;
+
+    std::mutex mutex_;
+    std::unordered_map<std::string, cv::Mat> last_frames_;  // keyed by camera_id, already prepared
+};
+
+}
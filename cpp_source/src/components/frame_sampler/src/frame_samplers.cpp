@@ -1,25 +1,135 @@
 #include "../include/frame_samplers.hpp"
+#include "../../../common/include/utils.hpp"
 
 namespace nl_video_analysis {
 
-void UniformFrameSampler::sampleFrames(ClipContainer& clip, int num_frames) {
+namespace {
+
+// Sampled frames are views into clip.frames; see the read-only contract on ClipContainer
+void assignSampledFrames(ClipContainer& clip, std::vector<int> indices) {
     clip.sampled_frames.clear();
+    clip.sampled_frames.reserve(indices.size());
+    for (int index : indices) {
+        clip.sampled_frames.push_back(clip.frames[index]);
+    }
+    clip.sampled_indices = std::move(indices);
+}
+
+}
 
-    if (clip.frames.empty()) {
-        return;
+void UniformFrameSampler::sampleFrames(ClipContainer& clip, int num_frames) {
+    assignSampledFrames(clip, uniformSampleIndices(static_cast<int>(clip.frames.size()), num_frames));
+}
+
+AdaptiveFrameSampler::AdaptiveFrameSampler(double min_activity, int analysis_width)
+    : min_activity_(min_activity), analysis_width_(std::max(16, analysis_width)) {}
+
+void AdaptiveFrameSampler::sampleFrames(ClipContainer& clip, int num_frames) {
+    assignSampledFrames(clip, selectIndices(scoreFrames(clip.frames), num_frames));
+}
+
+std::vector<double> AdaptiveFrameSampler::scoreFrames(const std::vector<cv::Mat>& frames) const {
+    std::vector<double> scores(frames.size(), 0.0);
+
+    // cv::norm runs on OpenCV's vectorized kernels; at 64 px wide a frame costs a few thousand byte ops
+    cv::Mat previous;
+    for (size_t i = 0; i < frames.size(); ++i) {
+        if (frames[i].empty()) {
+            continue;
+        }
+        cv::Mat current = downscaledGray(frames[i], analysis_width_, 3);
+        if (!previous.empty() && previous.size() == current.size()) {
+            scores[i] = cv::norm(previous, current, cv::NORM_L1) / static_cast<double>(current.total());
+        }
+        previous = current;
+    }
+
+    // The first frame has nothing to differ from; it is as informative as the change right after it
+    if (scores.size() > 1) {
+        scores[0] = scores[1];
     }
+    return scores;
+}
 
-    int total_frames = clip.frames.size();
-    num_frames = std::min(num_frames, total_frames);
+std::vector<int> AdaptiveFrameSampler::selectIndices(const std::vector<double>& scores, int num_frames) const {
+    int total = static_cast<int>(scores.size());
+    if (total == 0 || num_frames <= 0) {
+        return {};
+    }
+    num_frames = std::min(num_frames, total);
+
+    if (*std::max_element(scores.begin(), scores.end()) < min_activity_) {
+        return uniformSampleIndices(total, num_frames);
+    }
 
-    if (num_frames == 1) {
-        clip.sampled_frames.push_back(clip.frames[total_frames / 2].clone());
-    } else {
-        double step = static_cast<double>(total_frames - 1) / (num_frames - 1);
-        for (int i = 0; i < num_frames; ++i) {
-            int index = static_cast<int>(i * step);
-            clip.sampled_frames.push_back(clip.frames[index].clone());
+    std::vector<int> order(total);
+    for (int i = 0; i < total; ++i) {
+        order[i] = i;
+    }
+    // Stable so equally scored frames keep their temporal order
+    std::stable_sort(order.begin(), order.end(), [&scores](int a, int b) { return scores[a] > scores[b]; });
+
+    int min_gap = std::max(1, total / (2 * num_frames));
+    std::vector<int> selected;
+    selected.reserve(num_frames);
+    for (int index : order) {
+        if (scores[index] < min_activity_) {
+            break;
+        }
+        bool spaced = std::all_of(selected.begin(), selected.end(),
+                                  [&](int chosen) { return std::abs(chosen - index) >= min_gap; });
+        if (spaced) {
+            selected.push_back(index);
+            if (static_cast<int>(selected.size()) == num_frames) {
+                break;
+            }
+        }
+    }
+
+    // Quiet stretches get uniform coverage
+    for (int index : uniformSampleIndices(total, num_frames)) {
+        if (static_cast<int>(selected.size()) == num_frames) {
+            break;
+        }
+        if (std::find(selected.begin(), selected.end(), index) == selected.end()) {
+            selected.push_back(index);
         }
     }
+
+    std::sort(selected.begin(), selected.end());
+    return selected;
+}
+
+FrameSamplerRegistry& FrameSamplerRegistry::getInstance() {
+    static FrameSamplerRegistry instance;
+    return instance;
+}
+
+FrameSamplerRegistry::FrameSamplerRegistry() {
+    factories_["uniform"] = [] { return std::make_unique<UniformFrameSampler>(); };
+    factories_["adaptive"] = [] { return std::make_unique<AdaptiveFrameSampler>(); };
+}
+
+void FrameSamplerRegistry::registerSampler(const std::string& type, FrameSamplerFactory factory) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    factories_[type] = std::move(factory);
+}
+
+std::unique_ptr<IFrameSampler> FrameSamplerRegistry::create(const std::string& type) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = factories_.find(type);
+    if (it == factories_.end()) {
+        return nullptr;
+    }
+    return it->second();
+}
+
+std::vector<std::string> FrameSamplerRegistry::getTypes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<std::string> types;
+    for (const auto& entry : factories_) {
+        types.push_back(entry.first);
+    }
+    return types;
 }
 }
@@ -0,0 +1,61 @@
+#include "../include/motion_gate.hpp"
+#include "../../../common/include/utils.hpp"
+
+namespace nl_video_analysis {
+
+MotionGate::MotionGate(int pixel_threshold, double min_changed_fraction, int analysis_width)
+    : pixel_threshold_(pixel_threshold), min_changed_fraction_(min_changed_fraction),
+      analysis_width_(std::max(16, analysis_width)) {}
+
+MotionGateResult MotionGate::evaluate(const ClipContainer& clip) {
+    MotionGateResult result;
+
+    cv::Mat previous;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = last_frames_.find(clip.camera_id);
+        if (it != last_frames_.end()) {
+            previous = it->second;
+        }
+    }
+
+    size_t comparisons = 0;
+    for (const auto& frame : clip.sampled_frames) {
+        if (frame.empty()) {
+            continue;
+        }
+        cv::Mat current = prepare(frame);
+        if (!previous.empty() && previous.size() == current.size()) {
+            result.activity = std::max(result.activity, changedFraction(previous, current));
+            comparisons++;
+        }
+        previous = current;
+    }
+
+    if (!previous.empty()) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        last_frames_[clip.camera_id] = previous;
+    }
+
+    // With nothing to compare against (a camera's first clip with a single sampled frame) the clip counts as active
+    result.idle = comparisons > 0 && result.activity < min_changed_fraction_;
+    return result;
+}
+
+void MotionGate::reset(const std::string& camera_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    last_frames_.erase(camera_id);
+}
+
+cv::Mat MotionGate::prepare(const cv::Mat& frame) const {
+    return downscaledGray(frame, analysis_width_);
+}
+
+double MotionGate::changedFraction(const cv::Mat& previous, const cv::Mat& current) const {
+    cv::Mat diff;
+    cv::absdiff(previous, current, diff);
+    cv::threshold(diff, diff, pixel_threshold_, 255, cv::THRESH_BINARY);
+    return static_cast<double>(cv::countNonZero(diff)) / diff.total();
+}
+
+}
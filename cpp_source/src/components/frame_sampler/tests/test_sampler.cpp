@@ -1,6 +1,7 @@
 #define CATCH_CONFIG_MAIN
 #include "../../../lib/catch2/catch_amalgamated.hpp"
 #include "frame_samplers.hpp"
+#include "motion_gate.hpp"
 #include "../../../common/include/interfaces.hpp"
 #include <opencv2/opencv.hpp>
 
@@ -106,6 +107,40 @@ TEST_CASE("UniformFrameSampler preserves frame properties", "[frame_sampler]") {
     }
 }
 
+TEST_CASE("Sampled frames reference the clip's frames", "[frame_sampler]") {
+    SECTION("Uniform sampling records indices and shares pixel data") {
+        UniformFrameSampler sampler;
+        ClipContainer clip = createTestClip(10);
+        sampler.sampleFrames(clip, 5);
+
+        REQUIRE(clip.sampled_indices.size() == clip.sampled_frames.size());
+        for (size_t i = 0; i < clip.sampled_frames.size(); ++i) {
+            REQUIRE(clip.sampled_frames[i].data == clip.frames[clip.sampled_indices[i]].data);
+        }
+    }
+
+    SECTION("Adaptive sampling records indices and shares pixel data") {
+        AdaptiveFrameSampler sampler;
+        ClipContainer clip = createTestClip(20);
+        sampler.sampleFrames(clip, 4);
+
+        REQUIRE(clip.sampled_indices.size() == 4);
+        for (size_t i = 0; i < clip.sampled_frames.size(); ++i) {
+            REQUIRE(clip.sampled_frames[i].data == clip.frames[clip.sampled_indices[i]].data);
+        }
+    }
+
+    SECTION("Resampling replaces earlier samples") {
+        UniformFrameSampler sampler;
+        ClipContainer clip = createTestClip(10);
+        sampler.sampleFrames(clip, 5);
+        sampler.sampleFrames(clip, 2);
+
+        REQUIRE(clip.sampled_frames.size() == 2);
+        REQUIRE(clip.sampled_indices == std::vector<int>{0, 9});
+    }
+}
+
 TEST_CASE("ClipContainer metadata", "[frame_sampler]") {
     UniformFrameSampler sampler;
 
@@ -120,3 +155,108 @@ TEST_CASE("ClipContainer metadata", "[frame_sampler]") {
         REQUIRE(clip.frames.size() == 10); 
     }
 }
+
+TEST_CASE("AdaptiveFrameSampler picks frames where the scene changes", "[frame_sampler]") {
+    AdaptiveFrameSampler sampler;
+
+    SECTION("A static clip falls back to uniform sampling") {
+        std::vector<double> scores(30, 0.0);
+        REQUIRE(sampler.selectIndices(scores, 5) == std::vector<int>{0, 7, 14, 21, 29});
+    }
+
+    SECTION("Change peaks are picked, spaced apart and in temporal order") {
+        std::vector<double> scores(30, 0.1);
+        scores[10] = 20.0;
+        scores[11] = 18.0;  // same event as frame 10, closer than the minimum gap
+        scores[25] = 15.0;
+
+        std::vector<int> indices = sampler.selectIndices(scores, 3);
+        REQUIRE(indices.size() == 3);
+        REQUIRE(std::is_sorted(indices.begin(), indices.end()));
+        REQUIRE(std::find(indices.begin(), indices.end(), 10) != indices.end());
+        REQUIRE(std::find(indices.begin(), indices.end(), 25) != indices.end());
+        REQUIRE(std::find(indices.begin(), indices.end(), 11) == indices.end());
+    }
+
+    SECTION("Frames are scored by their difference to the previous frame") {
+        std::vector<cv::Mat> frames;
+        for (int i = 0; i < 10; ++i) {
+            cv::Mat frame(480, 640, CV_8UC3, cv::Scalar(40, 40, 40));
+            if (i >= 6) {
+                cv::rectangle(frame, cv::Rect(200, 150, 240, 180), cv::Scalar(230, 230, 230), cv::FILLED);
+            }
+            frames.push_back(frame);
+        }
+
+        std::vector<double> scores = sampler.scoreFrames(frames);
+        REQUIRE(scores.size() == 10);
+        REQUIRE(std::max_element(scores.begin(), scores.end()) - scores.begin() == 6);
+        REQUIRE(scores[3] == 0.0);
+    }
+
+    SECTION("Sampling keeps the requested count") {
+        ClipContainer clip = createTestClip(30);
+        sampler.sampleFrames(clip, 5);
+        REQUIRE(clip.sampled_frames.size() == 5);
+    }
+}
+
+TEST_CASE("FrameSamplerRegistry creates samplers by type", "[frame_sampler]") {
+    FrameSamplerRegistry& registry = FrameSamplerRegistry::getInstance();
+
+    REQUIRE(dynamic_cast<UniformFrameSampler*>(registry.create("uniform").get()) != nullptr);
+    REQUIRE(dynamic_cast<AdaptiveFrameSampler*>(registry.create("adaptive").get()) != nullptr);
+    REQUIRE(registry.create("does_not_exist") == nullptr);
+
+    registry.registerSampler("test_custom", [] { return std::make_unique<UniformFrameSampler>(); });
+    REQUIRE(registry.create("test_custom") != nullptr);
+}
+
+ClipContainer createSampledClip(const std::string& camera_id, int num_frames, int square_step) {
+    ClipContainer clip;
+    clip.camera_id = camera_id;
+    for (int i = 0; i < num_frames; ++i) {
+        cv::Mat frame(480, 640, CV_8UC3, cv::Scalar(40, 40, 40));
+        cv::rectangle(frame, cv::Rect(50 + i * square_step, 200, 80, 80), cv::Scalar(220, 220, 220), cv::FILLED);
+        clip.sampled_frames.push_back(frame);
+    }
+    return clip;
+}
+
+TEST_CASE("MotionGate detects idle clips", "[frame_sampler]") {
+    MotionGate gate;
+
+    SECTION("A static scene is idle") {
+        MotionGateResult result = gate.evaluate(createSampledClip("static_camera", 5, 0));
+        REQUIRE(result.idle);
+        REQUIRE(result.activity == 0.0);
+    }
+
+    SECTION("A moving object makes the clip active") {
+        MotionGateResult result = gate.evaluate(createSampledClip("moving_camera", 5, 40));
+        REQUIRE_FALSE(result.idle);
+        REQUIRE(result.activity > 0.002);
+    }
+
+    SECTION("Sensor noise is not motion") {
+        ClipContainer clip = createSampledClip("noisy_camera", 5, 0);
+        cv::RNG rng(42);
+        for (auto& frame : clip.sampled_frames) {
+            cv::Mat noise(frame.size(), CV_8UC3);
+            rng.fill(noise, cv::RNG::UNIFORM, 0, 6);
+            frame = frame + noise;
+        }
+        REQUIRE(gate.evaluate(clip).idle);
+    }
+
+    SECTION("Motion across a clip boundary is seen") {
+        REQUIRE_FALSE(gate.evaluate(createSampledClip("boundary_camera", 1, 0)).idle);  // nothing to compare yet
+
+        ClipContainer next = createSampledClip("boundary_camera", 1, 0);
+        cv::rectangle(next.sampled_frames[0], cv::Rect(400, 100, 80, 80), cv::Scalar(220, 220, 220), cv::FILLED);
+        REQUIRE_FALSE(gate.evaluate(next).idle);
+
+        REQUIRE(gate.evaluate(createSampledClip("boundary_camera", 1, 0)).idle == false);
+        REQUIRE(gate.evaluate(createSampledClip("boundary_camera", 1, 0)).idle);
+    }
+}
@@ -0,0 +1,133 @@
+// NMS benchmark over synthetic dense scenes.
+// Boxes are clustered around a few hundred object centres (as a low score threshold leaves them in a crowded
+// frame) and run through the previous index-rebuilding NMS and NmsEngine, class-agnostic and per class.
+// Reports the time per call and checks that both keep the same boxes.
+
+#include "nms.hpp"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <vector>
+
+using namespace nl_video_analysis;
+
+// The NMS YOLOXDetector used before NmsEngine, kept here as the baseline
+static std::vector<int> legacyNms(const std::vector<float>& boxes, const std::vector<float>& scores, float nms_thr) {
+    std::vector<int> indices(scores.size());
+    std::iota(indices.begin(), indices.end(), 0);
+    std::stable_sort(indices.begin(), indices.end(), [&scores](int i1, int i2) { return scores[i1] > scores[i2]; });
+
+    std::vector<float> areas(scores.size());
+    for (size_t i = 0; i < scores.size(); ++i) {
+        areas[i] = (boxes[i * 4 + 2] - boxes[i * 4] + 1) * (boxes[i * 4 + 3] - boxes[i * 4 + 1] + 1);
+    }
+
+    std::vector<int> keep;
+    while (!indices.empty()) {
+        int idx = indices[0];
+        keep.push_back(idx);
+
+        std::vector<int> new_indices;
+        for (size_t i = 1; i < indices.size(); ++i) {
+            int idx2 = indices[i];
+
+            float x1 = std::max(boxes[idx * 4], boxes[idx2 * 4]);
+            float y1 = std::max(boxes[idx * 4 + 1], boxes[idx2 * 4 + 1]);
+            float x2 = std::min(boxes[idx * 4 + 2], boxes[idx2 * 4 + 2]);
+            float y2 = std::min(boxes[idx * 4 + 3], boxes[idx2 * 4 + 3]);
+
+            float w = std::max(0.0f, x2 - x1 + 1);
+            float h = std::max(0.0f, y2 - y1 + 1);
+            float inter = w * h;
+
+            if (inter / (areas[idx] + areas[idx2] - inter) <= nms_thr) {
+                new_indices.push_back(idx2);
+            }
+        }
+        indices = new_indices;
+    }
+    return keep;
+}
+
+struct Scene {
+    std::vector<float> boxes;
+    std::vector<float> scores;
+    std::vector<int> classes;
+};
+
+static Scene makeScene(size_t count, size_t objects, std::mt19937& rng) {
+    std::uniform_real_distribution<float> position(0.0f, 1920.0f);
+    std::uniform_real_distribution<float> size(20.0f, 200.0f);
+    std::normal_distribution<float> jitter(0.0f, 6.0f);
+    std::uniform_real_distribution<float> score(0.05f, 1.0f);
+    std::uniform_int_distribution<int> class_id(0, 3);
+
+    std::vector<std::array<float, 4>> centres(objects);
+    for (auto& centre : centres) {
+        centre = {position(rng), position(rng) * 0.5625f, size(rng), size(rng)};
+    }
+
+    Scene scene;
+    for (size_t i = 0; i < count; ++i) {
+        const auto& centre = centres[i % objects];
+        float cx = centre[0] + jitter(rng);
+        float cy = centre[1] + jitter(rng);
+        float w = centre[2] + jitter(rng);
+        float h = centre[3] + jitter(rng);
+        scene.boxes.insert(scene.boxes.end(), {cx - w / 2, cy - h / 2, cx + w / 2, cy + h / 2});
+        scene.scores.push_back(score(rng));
+        scene.classes.push_back(class_id(rng));
+    }
+    return scene;
+}
+
+template <typename Fn>
+static double timePerCallUs(Fn&& fn, int iterations) {
+    fn();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        fn();
+    }
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / iterations;
+}
+
+int main(int argc, char* argv[]) {
+    int iterations = argc > 1 ? std::max(1, std::atoi(argv[1])) : 50;
+    float nms_thr = argc > 2 ? static_cast<float>(std::atof(argv[2])) : 0.45f;
+
+    std::cout << "=== NMS Benchmark: IoU threshold " << nms_thr << ", " << iterations << " iterations ===" << std::endl;
+
+    std::mt19937 rng(42);
+    NmsEngine engine;
+
+    for (size_t count : {100, 500, 1000, 2000, 4000, 8400}) {
+        Scene scene = makeScene(count, std::max<size_t>(1, count / 20), rng);
+
+        std::vector<int> legacy_keep;
+        double legacy_us = timePerCallUs([&] { legacy_keep = legacyNms(scene.boxes, scene.scores, nms_thr); }, iterations);
+
+        std::vector<int> keep;
+        double agnostic_us = timePerCallUs([&] {
+            keep = engine.run(scene.boxes.data(), scene.scores.data(), nullptr, count, nms_thr);
+        }, iterations);
+        bool same = keep == legacy_keep;
+
+        double per_class_us = timePerCallUs([&] {
+            engine.run(scene.boxes.data(), scene.scores.data(), scene.classes.data(), count, nms_thr);
+        }, iterations);
+
+        std::cout << std::fixed << std::setprecision(1)
+                  << "  " << std::setw(5) << count << " boxes"
+                  << " | legacy " << std::setw(9) << legacy_us << " us"
+                  << " | engine " << std::setw(8) << agnostic_us << " us (" << std::setprecision(1)
+                  << legacy_us / agnostic_us << "x)"
+                  << " | per-class " << std::setw(8) << per_class_us << " us"
+                  << " | kept " << keep.size() << (same ? "" : " MISMATCH") << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,95 @@
+// YOLOX preprocessing benchmark.
+// Compares the previous multi-pass path (pad, resize, convertTo, split, memcpy, then a separate fp16
+// conversion loop) against the fused LetterboxPreprocessor for fp32 and fp16 inputs at several source
+// resolutions, and reports the time per frame of each.
+
+#include "letterbox_preprocessor.hpp"
+#include <onnxruntime/core/session/onnxruntime_cxx_api.h>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+using namespace nl_video_analysis;
+
+// The preprocessing YOLOXDetector used before the fused kernel, kept here as the baseline
+static float legacyPreprocess(const cv::Mat& ori_frame, int target_w, int target_h, float* dst) {
+    cv::Mat padded_img(target_h, target_w, CV_8UC3, cv::Scalar(114, 114, 114));
+
+    float r = std::min(static_cast<float>(target_h) / ori_frame.rows, static_cast<float>(target_w) / ori_frame.cols);
+
+    int resized_h = static_cast<int>(ori_frame.rows * r);
+    int resized_w = static_cast<int>(ori_frame.cols * r);
+    cv::Mat resized_img;
+    cv::resize(ori_frame, resized_img, cv::Size(resized_w, resized_h), 0, 0, cv::INTER_LINEAR);
+
+    resized_img.copyTo(padded_img(cv::Rect(0, 0, resized_w, resized_h)));
+
+    cv::Mat float_img;
+    padded_img.convertTo(float_img, CV_32F);
+
+    std::vector<cv::Mat> channels(3);
+    cv::split(float_img, channels);
+    for (int c = 0; c < 3; ++c) {
+        std::memcpy(dst + c * target_h * target_w, channels[c].data, target_h * target_w * sizeof(float));
+    }
+
+    return r;
+}
+
+template <typename Fn>
+static double timePerFrameMs(Fn&& fn, int iterations) {
+    fn();  // warm-up, allocates the persistent buffers
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        fn();
+    }
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / iterations;
+}
+
+static void report(const std::string& name, double legacy_ms, double fused_ms) {
+    std::cout << std::fixed << std::setprecision(3)
+              << "  " << std::setw(5) << name
+              << " | legacy " << std::setw(7) << legacy_ms << " ms"
+              << " | fused " << std::setw(7) << fused_ms << " ms"
+              << " | " << std::setprecision(2) << legacy_ms / fused_ms << "x" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    int target = argc > 1 ? std::atoi(argv[1]) : 640;
+    int iterations = argc > 2 ? std::max(1, std::atoi(argv[2])) : 200;
+
+    std::cout << "=== Preprocess Benchmark: " << target << "x" << target << " input, " << iterations
+              << " iterations ===" << std::endl;
+
+    const std::vector<cv::Size> sources = {{640, 480}, {target, target}, {1280, 720}, {1920, 1080}, {3840, 2160}};
+    const size_t image_size = static_cast<size_t>(3) * target * target;
+
+    std::vector<float> fp32(image_size);
+    std::vector<Ort::Float16_t> fp16(image_size);
+    LetterboxPreprocessor letterbox(target, target);
+
+    for (const auto& size : sources) {
+        cv::Mat frame(size, CV_8UC3);
+        cv::randu(frame, cv::Scalar::all(0), cv::Scalar::all(255));
+        std::cout << "[" << size.width << "x" << size.height << "]" << std::endl;
+
+        double legacy_fp32 = timePerFrameMs([&] { legacyPreprocess(frame, target, target, fp32.data()); }, iterations);
+        double fused_fp32 = timePerFrameMs([&] { letterbox.run(frame, fp32.data()); }, iterations);
+        report("fp32", legacy_fp32, fused_fp32);
+
+        double legacy_fp16 = timePerFrameMs([&] {
+            legacyPreprocess(frame, target, target, fp32.data());
+            for (size_t i = 0; i < image_size; ++i) {
+                fp16[i] = Ort::Float16_t(fp32[i]);
+            }
+        }, iterations);
+        double fused_fp16 = timePerFrameMs([&] {
+            letterbox.run(frame, reinterpret_cast<uint16_t*>(fp16.data()));
+        }, iterations);
+        report("fp16", legacy_fp16, fused_fp16);
+    }
+
+    return 0;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <opencv2/opencv.hpp>
+
+namespace nl_video_analysis {
+
+// YOLOX input preparation in one pass: the frame is resized (top-left aligned, aspect kept) into a buffer
+// that persists across calls, then a single loop deinterleaves BGR into planar CHW and writes fp32 or fp16
+// straight into the caller's tensor buffer, filling the letterbox padding on the way. Pixel values are the
+// raw 0..255 bytes, as YOLOX expects.
+//
+// Frames already at the target size skip the resize and are read in place.
+class LetterboxPreprocessor {
+public:
+    LetterboxPreprocessor(int target_w = 640, int target_h = 640, uint8_t pad_value = 114);
+
+    void setTargetSize(int target_w, int target_h);
+
+    // dst holds 3 * target_h * target_w values; fp16 values are IEEE half bit patterns (Ort::Float16_t layout).
+    // Both return the resize ratio needed to map detections back onto the frame.
+    float run(const cv::Mat& image, float* dst);
+    float run(const cv::Mat& image, uint16_t* dst);
+
+    // Fills `count` values with the padding colour, e.g. the unused slots of a fixed-size batch
+    void fillPadding(float* dst, size_t count) const;
+    void fillPadding(uint16_t* dst, size_t count) const;
+
+    size_t getImageSize() const { return static_cast<size_t>(3) * target_h_ * target_w_; }
+
+    // Bytes 0..255 are exact in fp16, so the conversion is a table lookup
+    static const std::array<uint16_t, 256>& fp16Table();
+
+private:
+    // Returns the region of the resized frame inside the letterbox (a view of the input when no resize was needed)
+    cv::Mat resize(const cv::Mat& image, float& ratio);
+
+    template <typename T>
+    void writePlanar(const cv::Mat& resized, T* dst, T pad) const;
+
+    int target_w_;
+    int target_h_;
+    uint8_t pad_value_;
+    cv::Mat resized_;  // reused across calls; only reallocated when the resized size changes
+};
+
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace nl_video_analysis {
+
+// Greedy non-maximum suppression over xyxy boxes, for any detector's postprocessing.
+// Boxes are copied once into score-sorted structure-of-arrays buffers, so the IoU of one kept box against
+// every later box runs four lanes at a time (OpenCV universal intrinsics), without divisions. Suppression
+// is recorded in a bitmask, so nothing is erased or reallocated while boxes are kept. Areas use the
+// pixel-inclusive (+1) convention of the YOLOX reference implementation.
+//
+// Boxes only suppress boxes of the same group. Pass no groups for class-agnostic NMS, class ids for
+// per-class NMS, or e.g. image * num_classes + class to run a whole batch in one call.
+class NmsEngine {
+public:
+    // `boxes` holds x1, y1, x2, y2 per box. Returns the indices of the kept boxes, highest score first,
+    // stopping after `max_kept` boxes when it is non-zero. The result is valid until the next call.
+    const std::vector<int>& run(const float* boxes, const float* scores, const int* groups, size_t count,
+                                float iou_threshold, size_t max_kept = 0);
+
+private:
+    void sortAndGather(const float* boxes, const float* scores, const int* groups, size_t count);
+    void suppressAfter(size_t i, float iou_threshold);
+
+    std::vector<int> order_;  // original index of each sorted slot
+
+    // Sorted by descending score and padded to a multiple of the SIMD width; suppression bits of the padding
+    // are never read, so its values (zeros, a valid group) do not matter
+    std::vector<float> x1_;
+    std::vector<float> y1_;
+    std::vector<float> x2_;
+    std::vector<float> y2_;
+    std::vector<float> areas_;
+    std::vector<int> groups_;
+
+    std::vector<uint64_t> suppressed_;
+    std::vector<int> keep_;
+};
+
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "../../../common/include/interfaces.hpp"
+#include "nms.hpp"
+#include <vector>
+
+namespace nl_video_analysis {
+
+// Turns the raw YOLOX head output of one image ([anchors, 4 box + 1 objectness + classes]) into detections.
+// The anchor grids are built once per head layout. Anchors whose objectness alone cannot reach the score
+// threshold are skipped before anything else is read; the rest are scored over the configured classes only,
+// and only the surviving candidates get their box decoded. All intermediate buffers are reused across calls.
+class YOLOXDecoder {
+public:
+    YOLOXDecoder(const std::vector<int>& classes = {});
+
+    // Sets the head layout and rebuilds the anchor grids. Requested classes outside [0, num_classes) are
+    // ignored. Throws std::invalid_argument on a non-positive size, class count or stride.
+    void configure(int input_w, int input_h, int num_classes, const std::vector<int>& strides = {8, 16, 32});
+
+    // Number of anchors the heads of `strides` produce for an input of this size
+    static size_t countAnchors(int input_w, int input_h, const std::vector<int>& strides);
+
+    // Class-agnostic NMS (default) lets a box suppress overlapping boxes of any class
+    void setClassAgnosticNms(bool class_agnostic) { class_agnostic_nms_ = class_agnostic; }
+
+    // `ratio` is the letterbox resize ratio; boxes are returned in original frame coordinates
+    std::vector<Detection> decode(const float* outputs, size_t output_size, float ratio,
+                                  float score_threshold, float nms_threshold);
+
+    size_t getNumAnchors() const { return grid_.size(); }
+    int getNumClasses() const { return num_classes_; }
+    int getNumAttributes() const { return 5 + num_classes_; }
+    const std::vector<int>& getStrides() const { return strides_; }
+    // Classes that are actually scored (the requested ones the model has)
+    const std::vector<int>& getClasses() const { return classes_; }
+
+private:
+    struct GridCell {
+        float x;
+        float y;
+        float stride;
+    };
+
+    // Best score among the scored classes; ties go to the lowest class id
+    float bestClass(const float* class_scores, int& class_id) const;
+
+    std::vector<int> requested_classes_;
+    int num_classes_ = 0;
+    std::vector<int> strides_;
+    std::vector<int> classes_;  // sorted, unique, within [0, num_classes)
+    bool all_classes_ = false;  // every class is scored, so the whole row can be reduced at once
+    bool class_agnostic_nms_ = true;
+    std::vector<GridCell> grid_;
+
+    std::vector<float> candidate_boxes_;  // x1, y1, x2, y2 per candidate
+    std::vector<float> candidate_scores_;
+    std::vector<int> candidate_classes_;
+    NmsEngine nms_;
+};
+
+}
@@ -1,41 +1,67 @@
 #include "../../../common/include/interfaces.hpp"
 #include "../../../common/include/base_model.hpp"
+#include "letterbox_preprocessor.hpp"
+#include "yolox_decoder.hpp"
 #include <opencv2/opencv.hpp>
 
 namespace nl_video_analysis {
 
 class YOLOXDetector : public IBaseModel<cv::Mat, std::vector<Detection>> {
     public:
-        YOLOXDetector(const std::string& model_path, int num_threads, bool is_fp16, const std::vector<int>& classes);
+        YOLOXDetector(const std::string& model_path, int num_threads, bool is_fp16, const std::vector<int>& classes,
+                      int max_batch_size = 8);
+        // Another inference context on a loaded session (see ModelPool): shares the weights, not the buffers
+        YOLOXDetector(std::shared_ptr<Ort::Session> session, bool is_fp16, const std::vector<int>& classes,
+                      int max_batch_size = 8);
         ~YOLOXDetector() = default;
 
         std::vector<Detection> detect(const cv::Mat& image, float score_thr = 0.25f, float nms_thr = 0.45f);
 
+        // Runs all images through the model in as few Session::Run calls as possible.
+        // Models with a dynamic batch dimension get chunks of up to max_batch_size images,
+        // fixed-batch models get chunks of their exported batch size (padded if needed).
+        // Returns one detection list per input image, in input order.
+        std::vector<std::vector<Detection>> detectBatch(const std::vector<cv::Mat>& images,
+                                                        float score_thr = 0.25f, float nms_thr = 0.45f);
+
+        int getMaxBatchSize() const { return max_batch_size_; }
+        bool hasDynamicBatch() const { return has_dynamic_batch_; }
+
+        // Per-class NMS keeps overlapping boxes of different classes; class-agnostic by default
+        void setClassAgnosticNms(bool class_agnostic) { decoder_.setClassAgnosticNms(class_agnostic); }
+
     protected:
         std::vector<Ort::Value> preprocess(const cv::Mat& input) override;
         std::vector<Detection> postprocess(std::vector<Ort::Value>& output_tensors) override;
 
     private:
-        std::pair<std::vector<float>, float> preprocessImage(const cv::Mat& ori_frame);
-        std::vector<Detection> postprocessOutputs(const float* outputs, size_t output_size, float ratio,
-                                                float score_threshold, float nms_threshold);
-        void xywh_to_xyxy(std::vector<float>& boxes, float ratio);
-        std::vector<int> nms(const std::vector<float>& boxes, const std::vector<float>& scores, float nms_thr);
-        std::vector<Detection> multiclass_nms_class_agnostic(const std::vector<float>& boxes,
-                                                            const std::vector<std::vector<float>>& scores,
-                                                            float nms_thr, float score_thr);
+        // Derives the class count and head strides from the output shape and model metadata; throws when they
+        // do not match the input size
+        void configureDecoder(const std::vector<int>& classes);
+        std::string lookupMetadata(const char* key);
+        std::vector<Ort::Value> preprocessBatch(const std::vector<cv::Mat>& images, size_t begin, size_t end);
+        std::vector<Ort::Value> createInputTensor(int64_t batch_size);
+        float preprocessImage(const cv::Mat& ori_frame, size_t slot);
+        const float* outputAsFloat(Ort::Value& output_tensor, size_t& output_size);
         std::vector<int64_t> input_shape_;
         int target_h_;
         int target_w_;
         bool is_fp16_;
+        bool has_dynamic_batch_;
+        int max_batch_size_;
 
         float score_threshold_;
         float nms_threshold_;
         float ratio_;
-        std::vector<int> classes_;
+        std::vector<float> batch_ratios_;
+        // Anchor grids are built once for the model's head layout; scores only the requested classes
+        YOLOXDecoder decoder_;
 
+        // Writes straight into input_data_fp16_ / input_data_fp32_; keeps its resize buffer between frames
+        LetterboxPreprocessor letterbox_;
         std::vector<Ort::Float16_t> input_data_fp16_;
         std::vector<float> input_data_fp32_;
+        std::vector<float> output_data_fp32_;
 };
 
 }
@@ -0,0 +1,165 @@
+#include "../include/letterbox_preprocessor.hpp"
+#include <opencv2/core/hal/intrin.hpp>
+#include <algorithm>
+#include <stdexcept>
+
+namespace nl_video_analysis {
+
+namespace {
+
+uint16_t halfFromByte(int value) {
+    if (value == 0) {
+        return 0;
+    }
+    int exponent = 0;
+    while ((value >> (exponent + 1)) != 0) {
+        exponent++;
+    }
+    uint16_t mantissa = static_cast<uint16_t>((value << (10 - exponent)) & 0x3FF);
+    return static_cast<uint16_t>(((exponent + 15) << 10) | mantissa);
+}
+
+// Deinterleaves one row of packed BGR bytes into three planes
+void convertRow(const uchar* src, int width, float* b, float* g, float* r) {
+    int x = 0;
+#if CV_SIMD128
+    for (; x <= width - 16; x += 16) {
+        cv::v_uint8x16 vb, vg, vr;
+        cv::v_load_deinterleave(src + 3 * x, vb, vg, vr);
+
+        float* planes[3] = {b + x, g + x, r + x};
+        cv::v_uint8x16 channels[3] = {vb, vg, vr};
+        for (int c = 0; c < 3; ++c) {
+            cv::v_uint16x8 lo, hi;
+            cv::v_expand(channels[c], lo, hi);
+            cv::v_uint32x4 q0, q1, q2, q3;
+            cv::v_expand(lo, q0, q1);
+            cv::v_expand(hi, q2, q3);
+            cv::v_store(planes[c], cv::v_cvt_f32(cv::v_reinterpret_as_s32(q0)));
+            cv::v_store(planes[c] + 4, cv::v_cvt_f32(cv::v_reinterpret_as_s32(q1)));
+            cv::v_store(planes[c] + 8, cv::v_cvt_f32(cv::v_reinterpret_as_s32(q2)));
+            cv::v_store(planes[c] + 12, cv::v_cvt_f32(cv::v_reinterpret_as_s32(q3)));
+        }
+    }
+#endif
+    for (; x < width; ++x) {
+        b[x] = src[3 * x];
+        g[x] = src[3 * x + 1];
+        r[x] = src[3 * x + 2];
+    }
+}
+
+void convertRow(const uchar* src, int width, uint16_t* b, uint16_t* g, uint16_t* r) {
+    const auto& table = LetterboxPreprocessor::fp16Table();
+    int x = 0;
+#if CV_SIMD128
+    uchar planes[3][16];
+    for (; x <= width - 16; x += 16) {
+        cv::v_uint8x16 vb, vg, vr;
+        cv::v_load_deinterleave(src + 3 * x, vb, vg, vr);
+        cv::v_store(planes[0], vb);
+        cv::v_store(planes[1], vg);
+        cv::v_store(planes[2], vr);
+        for (int i = 0; i < 16; ++i) {
+            b[x + i] = table[planes[0][i]];
+            g[x + i] = table[planes[1][i]];
+            r[x + i] = table[planes[2][i]];
+        }
+    }
+#endif
+    for (; x < width; ++x) {
+        b[x] = table[src[3 * x]];
+        g[x] = table[src[3 * x + 1]];
+        r[x] = table[src[3 * x + 2]];
+    }
+}
+
+}
+
+LetterboxPreprocessor::LetterboxPreprocessor(int target_w, int target_h, uint8_t pad_value)
+    : target_w_(target_w), target_h_(target_h), pad_value_(pad_value) {}
+
+void LetterboxPreprocessor::setTargetSize(int target_w, int target_h) {
+    target_w_ = target_w;
+    target_h_ = target_h;
+}
+
+const std::array<uint16_t, 256>& LetterboxPreprocessor::fp16Table() {
+    static const std::array<uint16_t, 256> table = [] {
+        std::array<uint16_t, 256> values{};
+        for (int i = 0; i < 256; ++i) {
+            values[i] = halfFromByte(i);
+        }
+        return values;
+    }();
+    return table;
+}
+
+float LetterboxPreprocessor::run(const cv::Mat& image, float* dst) {
+    float ratio = 1.0f;
+    cv::Mat resized = resize(image, ratio);
+    writePlanar(resized, dst, static_cast<float>(pad_value_));
+    return ratio;
+}
+
+float LetterboxPreprocessor::run(const cv::Mat& image, uint16_t* dst) {
+    float ratio = 1.0f;
+    cv::Mat resized = resize(image, ratio);
+    writePlanar(resized, dst, fp16Table()[pad_value_]);
+    return ratio;
+}
+
+void LetterboxPreprocessor::fillPadding(float* dst, size_t count) const {
+    std::fill(dst, dst + count, static_cast<float>(pad_value_));
+}
+
+void LetterboxPreprocessor::fillPadding(uint16_t* dst, size_t count) const {
+    std::fill(dst, dst + count, fp16Table()[pad_value_]);
+}
+
+cv::Mat LetterboxPreprocessor::resize(const cv::Mat& image, float& ratio) {
+    if (image.empty()) {
+        throw std::invalid_argument("LetterboxPreprocessor: empty image");
+    }
+    if (image.type() != CV_8UC3) {
+        throw std::invalid_argument("LetterboxPreprocessor: expected an 8-bit BGR image");
+    }
+
+    ratio = std::min(static_cast<float>(target_h_) / image.rows, static_cast<float>(target_w_) / image.cols);
+    int resized_h = static_cast<int>(image.rows * ratio);
+    int resized_w = static_cast<int>(image.cols * ratio);
+
+    if (resized_w == image.cols && resized_h == image.rows) {
+        return image;
+    }
+
+    // cv::resize reuses resized_'s buffer when the size matches the previous frame's
+    cv::resize(image, resized_, cv::Size(resized_w, resized_h), 0, 0, cv::INTER_LINEAR);
+    return resized_;
+}
+
+template <typename T>
+void LetterboxPreprocessor::writePlanar(const cv::Mat& resized, T* dst, T pad) const {
+    const size_t plane_size = static_cast<size_t>(target_h_) * target_w_;
+    T* planes[3] = {dst, dst + plane_size, dst + 2 * plane_size};
+    const int width = std::min(resized.cols, target_w_);
+    const int height = std::min(resized.rows, target_h_);
+
+    for (int y = 0; y < height; ++y) {
+        size_t offset = static_cast<size_t>(y) * target_w_;
+        convertRow(resized.ptr<uchar>(y), width, planes[0] + offset, planes[1] + offset, planes[2] + offset);
+        if (width < target_w_) {
+            for (T* plane : planes) {
+                std::fill(plane + offset + width, plane + offset + target_w_, pad);
+            }
+        }
+    }
+
+    // Rows below the image are all padding
+    size_t padded_from = static_cast<size_t>(height) * target_w_;
+    for (T* plane : planes) {
+        std::fill(plane + padded_from, plane + plane_size, pad);
+    }
+}
+
+}
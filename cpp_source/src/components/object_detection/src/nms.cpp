@@ -0,0 +1,109 @@
+#include "../include/nms.hpp"
+#include <opencv2/core/hal/intrin.hpp>
+#include <algorithm>
+#include <numeric>
+
+namespace nl_video_analysis {
+
+namespace {
+
+constexpr size_t kLanes = 4;
+
+}
+
+const std::vector<int>& NmsEngine::run(const float* boxes, const float* scores, const int* groups, size_t count,
+                                       float iou_threshold, size_t max_kept) {
+    keep_.clear();
+    if (count == 0) {
+        return keep_;
+    }
+
+    sortAndGather(boxes, scores, groups, count);
+    suppressed_.assign((count + 63) / 64, 0);
+
+    for (size_t i = 0; i < count; ++i) {
+        if (suppressed_[i >> 6] & (uint64_t(1) << (i & 63))) {
+            continue;
+        }
+        keep_.push_back(order_[i]);
+        if (max_kept > 0 && keep_.size() == max_kept) {
+            break;
+        }
+        suppressAfter(i, iou_threshold);
+    }
+    return keep_;
+}
+
+void NmsEngine::sortAndGather(const float* boxes, const float* scores, const int* groups, size_t count) {
+    order_.resize(count);
+    std::iota(order_.begin(), order_.end(), 0);
+    std::stable_sort(order_.begin(), order_.end(), [scores](int i1, int i2) { return scores[i1] > scores[i2]; });
+
+    // Lanes past `count` are computed but their bits are never read, so the padding values do not matter
+    size_t padded = (count + kLanes - 1) / kLanes * kLanes;
+    x1_.assign(padded, 0.0f);
+    y1_.assign(padded, 0.0f);
+    x2_.assign(padded, 0.0f);
+    y2_.assign(padded, 0.0f);
+    areas_.assign(padded, 0.0f);
+    groups_.assign(padded, 0);
+
+    for (size_t k = 0; k < count; ++k) {
+        const float* box = boxes + static_cast<size_t>(order_[k]) * 4;
+        x1_[k] = box[0];
+        y1_[k] = box[1];
+        x2_[k] = box[2];
+        y2_[k] = box[3];
+        areas_[k] = (box[2] - box[0] + 1) * (box[3] - box[1] + 1);
+        groups_[k] = groups ? groups[order_[k]] : 0;
+    }
+}
+
+void NmsEngine::suppressAfter(size_t i, float iou_threshold) {
+    const size_t count = order_.size();
+    // Blocks start on a lane boundary, so a block never straddles two bitmask words. Lanes at or before i
+    // only mark boxes that were already visited.
+    size_t j = (i + 1) / kLanes * kLanes;
+
+    // IoU > threshold is tested as inter > threshold * union, which needs no division
+#if CV_SIMD128
+    const cv::v_float32x4 bx1 = cv::v_setall_f32(x1_[i]);
+    const cv::v_float32x4 by1 = cv::v_setall_f32(y1_[i]);
+    const cv::v_float32x4 bx2 = cv::v_setall_f32(x2_[i]);
+    const cv::v_float32x4 by2 = cv::v_setall_f32(y2_[i]);
+    const cv::v_float32x4 barea = cv::v_setall_f32(areas_[i]);
+    const cv::v_int32x4 bgroup = cv::v_setall_s32(groups_[i]);
+    const cv::v_float32x4 zero = cv::v_setzero_f32();
+    const cv::v_float32x4 one = cv::v_setall_f32(1.0f);
+    const cv::v_float32x4 threshold = cv::v_setall_f32(iou_threshold);
+
+    for (; j < count; j += kLanes) {
+        // In crowded scenes most later boxes are already suppressed; skip blocks with nothing left to test
+        if (((suppressed_[j >> 6] >> (j & 63)) & 0xF) == 0xF) {
+            continue;
+        }
+        cv::v_float32x4 w = cv::v_min(bx2, cv::v_load(&x2_[j])) - cv::v_max(bx1, cv::v_load(&x1_[j])) + one;
+        cv::v_float32x4 h = cv::v_min(by2, cv::v_load(&y2_[j])) - cv::v_max(by1, cv::v_load(&y1_[j])) + one;
+        cv::v_float32x4 inter = cv::v_max(w, zero) * cv::v_max(h, zero);
+        cv::v_float32x4 uni = barea + cv::v_load(&areas_[j]) - inter;
+
+        cv::v_float32x4 overlaps = inter > threshold * uni;
+        cv::v_float32x4 same_group = cv::v_reinterpret_as_f32(cv::v_load(&groups_[j]) == bgroup);
+        int bits = cv::v_signmask(overlaps & same_group);
+        suppressed_[j >> 6] |= static_cast<uint64_t>(bits) << (j & 63);
+    }
+#endif
+    for (; j < count; ++j) {
+        if (groups_[j] != groups_[i]) {
+            continue;
+        }
+        float w = std::max(0.0f, std::min(x2_[i], x2_[j]) - std::max(x1_[i], x1_[j]) + 1);
+        float h = std::max(0.0f, std::min(y2_[i], y2_[j]) - std::max(y1_[i], y1_[j]) + 1);
+        float inter = w * h;
+        if (inter > iou_threshold * (areas_[i] + areas_[j] - inter)) {
+            suppressed_[j >> 6] |= uint64_t(1) << (j & 63);
+        }
+    }
+}
+
+}
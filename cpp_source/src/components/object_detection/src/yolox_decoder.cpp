@@ -0,0 +1,147 @@
+#include "../include/yolox_decoder.hpp"
+#include <opencv2/core/hal/intrin.hpp>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace nl_video_analysis {
+
+YOLOXDecoder::YOLOXDecoder(const std::vector<int>& classes)
+    : requested_classes_(classes) {}
+
+void YOLOXDecoder::configure(int input_w, int input_h, int num_classes, const std::vector<int>& strides) {
+    if (input_w <= 0 || input_h <= 0 || num_classes <= 0 || strides.empty() ||
+        std::any_of(strides.begin(), strides.end(), [](int stride) { return stride <= 0; })) {
+        throw std::invalid_argument("YOLOXDecoder: invalid head layout");
+    }
+
+    num_classes_ = num_classes;
+    strides_ = strides;
+
+    classes_.clear();
+    for (int class_id : requested_classes_) {
+        if (class_id >= 0 && class_id < num_classes_) {
+            classes_.push_back(class_id);
+        }
+    }
+    std::sort(classes_.begin(), classes_.end());
+    classes_.erase(std::unique(classes_.begin(), classes_.end()), classes_.end());
+    all_classes_ = static_cast<int>(classes_.size()) == num_classes_;
+
+    grid_.clear();
+    grid_.reserve(countAnchors(input_w, input_h, strides_));
+    for (int stride : strides_) {
+        int hsize = input_h / stride;
+        int wsize = input_w / stride;
+        for (int y = 0; y < hsize; ++y) {
+            for (int x = 0; x < wsize; ++x) {
+                grid_.push_back({static_cast<float>(x), static_cast<float>(y), static_cast<float>(stride)});
+            }
+        }
+    }
+}
+
+size_t YOLOXDecoder::countAnchors(int input_w, int input_h, const std::vector<int>& strides) {
+    size_t anchors = 0;
+    for (int stride : strides) {
+        anchors += static_cast<size_t>(input_h / stride) * static_cast<size_t>(input_w / stride);
+    }
+    return anchors;
+}
+
+float YOLOXDecoder::bestClass(const float* class_scores, int& class_id) const {
+    if (!all_classes_) {
+        float best = class_scores[classes_[0]];
+        class_id = classes_[0];
+        for (size_t i = 1; i < classes_.size(); ++i) {
+            if (class_scores[classes_[i]] > best) {
+                best = class_scores[classes_[i]];
+                class_id = classes_[i];
+            }
+        }
+        return best;
+    }
+
+    int c = 0;
+    float best = class_scores[0];
+#if CV_SIMD128
+    if (num_classes_ >= 4) {
+        cv::v_float32x4 vmax = cv::v_load(class_scores);
+        for (c = 4; c <= num_classes_ - 4; c += 4) {
+            vmax = cv::v_max(vmax, cv::v_load(class_scores + c));
+        }
+        best = cv::v_reduce_max(vmax);
+    }
+#endif
+    for (; c < num_classes_; ++c) {
+        best = std::max(best, class_scores[c]);
+    }
+
+    class_id = static_cast<int>(std::find(class_scores, class_scores + num_classes_, best) - class_scores);
+    return best;
+}
+
+std::vector<Detection> YOLOXDecoder::decode(const float* outputs, size_t output_size, float ratio,
+                                            float score_threshold, float nms_threshold) {
+    candidate_boxes_.clear();
+    candidate_scores_.clear();
+    candidate_classes_.clear();
+
+    if (classes_.empty()) {
+        return {};
+    }
+
+    const size_t num_attrs = static_cast<size_t>(getNumAttributes());
+    const size_t num_anchors = std::min(grid_.size(), output_size / num_attrs);
+
+    for (size_t i = 0; i < num_anchors; ++i) {
+        const float* row = outputs + i * num_attrs;
+
+        // Class probabilities are at most 1, so the objectness bounds every class score of the anchor
+        float objectness = row[4];
+        if (objectness <= score_threshold) {
+            continue;
+        }
+
+        int class_id = 0;
+        float score = objectness * bestClass(row + 5, class_id);
+        if (score <= score_threshold) {
+            continue;
+        }
+
+        const GridCell& cell = grid_[i];
+        float cx = (row[0] + cell.x) * cell.stride;
+        float cy = (row[1] + cell.y) * cell.stride;
+        float half_w = std::exp(row[2]) * cell.stride * 0.5f;
+        float half_h = std::exp(row[3]) * cell.stride * 0.5f;
+
+        candidate_boxes_.push_back((cx - half_w) / ratio);
+        candidate_boxes_.push_back((cy - half_h) / ratio);
+        candidate_boxes_.push_back((cx + half_w) / ratio);
+        candidate_boxes_.push_back((cy + half_h) / ratio);
+        candidate_scores_.push_back(score);
+        candidate_classes_.push_back(class_id);
+    }
+
+    if (candidate_scores_.empty()) {
+        return {};
+    }
+
+    std::vector<Detection> detections;
+    const int* groups = class_agnostic_nms_ ? nullptr : candidate_classes_.data();
+    const auto& keep = nms_.run(candidate_boxes_.data(), candidate_scores_.data(), groups, candidate_scores_.size(),
+                                nms_threshold);
+    for (int idx : keep) {
+        Detection det;
+        det.x1 = candidate_boxes_[idx * 4];
+        det.y1 = candidate_boxes_[idx * 4 + 1];
+        det.x2 = candidate_boxes_[idx * 4 + 2];
+        det.y2 = candidate_boxes_[idx * 4 + 3];
+        det.score = candidate_scores_[idx];
+        det.class_id = candidate_classes_[idx];
+        detections.push_back(det);
+    }
+    return detections;
+}
+
+}
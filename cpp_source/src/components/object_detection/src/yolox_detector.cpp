@@ -3,15 +3,47 @@
 #include <iostream>
 #include <numeric>
 #include <algorithm>
+#include <cstring>
+#include <set>
+#include <sstream>
+#include <stdexcept>
 
 namespace nl_video_analysis {
-    
-YOLOXDetector::YOLOXDetector(const std::string& model_path, int num_threads, bool is_fp16, const std::vector<int>& classes)
-    : IBaseModel<cv::Mat, std::vector<Detection>>(model_path, num_threads),
+
+namespace {
+
+// Parses integer lists such as "8,16,32" or "[8, 16, 32]" from model metadata
+std::vector<int> parseIntList(const std::string& text) {
+    std::string cleaned = text;
+    for (char& c : cleaned) {
+        if (c == '[' || c == ']' || c == ',') {
+            c = ' ';
+        }
+    }
+    std::vector<int> values;
+    std::istringstream stream(cleaned);
+    int value = 0;
+    while (stream >> value) {
+        values.push_back(value);
+    }
+    return values;
+}
+
+}
+
+YOLOXDetector::YOLOXDetector(const std::string& model_path, int num_threads, bool is_fp16, const std::vector<int>& classes,
+                             int max_batch_size)
+    : YOLOXDetector(ONNXSessionBuilder(model_path, num_threads).build(), is_fp16, classes, max_batch_size)
+{
+}
+
+YOLOXDetector::YOLOXDetector(std::shared_ptr<Ort::Session> session, bool is_fp16, const std::vector<int>& classes,
+                             int max_batch_size)
+    : IBaseModel<cv::Mat, std::vector<Detection>>(std::move(session)),
       score_threshold_(0.25f),
       nms_threshold_(0.45f),
       is_fp16_(is_fp16),
-      classes_(classes),
+      decoder_(classes),
       ratio_(1.0f)
 {
     Ort::AllocatorWithDefaultOptions allocator;
@@ -19,294 +51,226 @@ YOLOXDetector::YOLOXDetector(const std::string& model_path, int num_threads, boo
     auto tensor_info = input_type_info.GetTensorTypeAndShapeInfo();
     input_shape_ = tensor_info.GetShape();
 
+    if (input_shape_.size() != 4 || input_shape_[2] <= 0 || input_shape_[3] <= 0) {
+        throw std::runtime_error("Expected a 4D YOLOX input tensor with a fixed spatial size");
+    }
     target_h_ = static_cast<int>(input_shape_[2]);
     target_w_ = static_cast<int>(input_shape_[3]);
+    letterbox_.setTargetSize(target_w_, target_h_);
+    configureDecoder(classes);
+
+    // A non-positive batch dimension means the model was exported with a dynamic batch axis
+    has_dynamic_batch_ = input_shape_[0] <= 0;
+    max_batch_size_ = has_dynamic_batch_ ? std::max(1, max_batch_size) : static_cast<int>(input_shape_[0]);
+    LOG_INFO("YOLOXDetector initialized: input {}x{}, {} batch (max {}), {} classes, {} anchors",
+             target_w_, target_h_, has_dynamic_batch_ ? "dynamic" : "fixed", max_batch_size_,
+             decoder_.getNumClasses(), decoder_.getNumAnchors());
 }
 
-std::vector<Detection> YOLOXDetector::detect(const cv::Mat& image, float score_thr, float nms_thr) {
-    score_threshold_ = score_thr;
-    nms_threshold_ = nms_thr;
-    return run(image);
+std::string YOLOXDetector::lookupMetadata(const char* key) {
+    Ort::AllocatorWithDefaultOptions allocator;
+    Ort::ModelMetadata metadata = session_->GetModelMetadata();
+    Ort::AllocatedStringPtr value = metadata.LookupCustomMetadataMapAllocated(key, allocator);
+    return value ? std::string(value.get()) : std::string();
 }
 
-std::vector<Ort::Value> YOLOXDetector::preprocess(const cv::Mat& input) {
-    ScopedTimer timer("detection_preprocess");
+void YOLOXDetector::configureDecoder(const std::vector<int>& classes) {
+    // Output is [batch, anchors, 4 box + 1 objectness + classes]
+    auto output_shape = session_->GetOutputTypeInfo(0).GetTensorTypeAndShapeInfo().GetShape();
+    if (output_shape.size() != 3) {
+        throw std::runtime_error("Expected a 3D YOLOX output tensor [batch, anchors, 5 + classes]");
+    }
 
-    auto [input_data, ratio] = preprocessImage(input);
-    ratio_ = ratio;
+    // The class count comes from the output shape; exports with a dynamic last axis must state it in metadata
+    int num_classes = output_shape[2] > 0 ? static_cast<int>(output_shape[2]) - 5 : 0;
+    if (output_shape[2] <= 0) {
+        std::vector<int> declared = parseIntList(lookupMetadata("num_classes"));
+        num_classes = declared.size() == 1 ? declared[0] : 0;
+    }
+    if (num_classes <= 0) {
+        throw std::runtime_error("Cannot derive the class count of the YOLOX model from its output shape or metadata");
+    }
 
-    std::vector<int64_t> input_shape = {1, 3, target_h_, target_w_};
-    std::vector<Ort::Value> tensors;
+    // Strides come from the "strides" metadata when the export declares them, otherwise from the anchor
+    // count: the standard P3-P5 heads first, then the P3-P6 heads of the larger variants
+    std::vector<std::vector<int>> candidates;
+    std::vector<int> declared_strides = parseIntList(lookupMetadata("strides"));
+    if (!declared_strides.empty()) {
+        candidates.push_back(declared_strides);
+    } else {
+        candidates = {{8, 16, 32}, {8, 16, 32, 64}};
+    }
 
-    if (is_fp16_) {
-        std::vector<Ort::Float16_t> input_data_fp16(input_data.size());
-        for (size_t i = 0; i < input_data.size(); ++i) {
-            input_data_fp16[i] = Ort::Float16_t(input_data[i]);
+    const std::vector<int>* strides = nullptr;
+    for (const auto& candidate : candidates) {
+        bool valid = std::all_of(candidate.begin(), candidate.end(), [](int stride) { return stride > 0; });
+        if (valid && (output_shape[1] <= 0 ||
+                      YOLOXDecoder::countAnchors(target_w_, target_h_, candidate) == static_cast<size_t>(output_shape[1]))) {
+            strides = &candidate;
+            break;
         }
-        input_data_fp16_ = std::move(input_data_fp16);
+    }
+    if (!strides) {
+        throw std::runtime_error("YOLOX output has " + std::to_string(output_shape[1]) +
+                                 " anchors, which no known stride layout produces for a " +
+                                 std::to_string(target_w_) + "x" + std::to_string(target_h_) +
+                                 " input; declare the strides in the model's \"strides\" metadata");
+    }
 
-        auto tensor = Ort::Value::CreateTensor<Ort::Float16_t>(
-            memory_info_,
-            input_data_fp16_.data(),
-            input_data_fp16_.size(),
-            input_shape.data(),
-            input_shape.size()
-        );
-        tensors.push_back(std::move(tensor));
-    } else {
-        input_data_fp32_ = std::move(input_data);
+    decoder_.configure(target_w_, target_h_, num_classes, *strides);
 
-        auto tensor = Ort::Value::CreateTensor<float>(
-            memory_info_,
-            input_data_fp32_.data(),
-            input_data_fp32_.size(),
-            input_shape.data(),
-            input_shape.size()
-        );
-        tensors.push_back(std::move(tensor));
+    if (decoder_.getClasses().size() != std::set<int>(classes.begin(), classes.end()).size()) {
+        LOG_WARN("YOLOXDetector: the model has {} classes, requested classes outside [0, {}) are ignored",
+                 num_classes, num_classes);
     }
+    if (decoder_.getClasses().empty()) {
+        LOG_WARN("YOLOXDetector: no requested class exists in the model, nothing will be detected");
+    }
+}
 
-    return tensors;
+std::vector<Detection> YOLOXDetector::detect(const cv::Mat& image, float score_thr, float nms_thr) {
+    score_threshold_ = score_thr;
+    nms_threshold_ = nms_thr;
+    return run(image);
 }
 
-std::pair<std::vector<float>, float> YOLOXDetector::preprocessImage(const cv::Mat& ori_frame) {
-    cv::Mat padded_img(target_h_, target_w_, CV_8UC3, cv::Scalar(114, 114, 114));
+std::vector<std::vector<Detection>> YOLOXDetector::detectBatch(const std::vector<cv::Mat>& images,
+                                                              float score_thr, float nms_thr) {
+    score_threshold_ = score_thr;
+    nms_threshold_ = nms_thr;
+
+    std::vector<std::vector<Detection>> results;
+    results.reserve(images.size());
 
-    float r = std::min(static_cast<float>(target_h_) / ori_frame.rows,
-                       static_cast<float>(target_w_) / ori_frame.cols);
+    const size_t chunk_size = static_cast<size_t>(max_batch_size_);
+    for (size_t begin = 0; begin < images.size(); begin += chunk_size) {
+        size_t end = std::min(begin + chunk_size, images.size());
 
-    int resized_h = static_cast<int>(ori_frame.rows * r);
-    int resized_w = static_cast<int>(ori_frame.cols * r);
-    cv::Mat resized_img;
-    cv::resize(ori_frame, resized_img, cv::Size(resized_w, resized_h), 0, 0, cv::INTER_LINEAR);
+        std::vector<Ort::Value> input_tensors = preprocessBatch(images, begin, end);
+        std::vector<Ort::Value>& output_tensors = infer(input_tensors);
 
-    resized_img.copyTo(padded_img(cv::Rect(0, 0, resized_w, resized_h)));
+        ScopedTimer timer("detection_postprocess");
+        size_t output_size = 0;
+        const float* outputs = outputAsFloat(output_tensors[0], output_size);
 
-    cv::Mat float_img;
-    padded_img.convertTo(float_img, CV_32F);
+        // Output is [batch, anchors, attrs]; padded slots of fixed-batch models are ignored
+        int64_t output_batch = output_tensors[0].GetTensorTypeAndShapeInfo().GetShape()[0];
+        size_t per_image_size = output_size / static_cast<size_t>(output_batch);
 
-    std::vector<cv::Mat> channels(3);
-    cv::split(float_img, channels);
-    std::vector<float> input_data(3 * target_h_ * target_w_);
-    for (int c = 0; c < 3; ++c) {
-        std::memcpy(input_data.data() + c * target_h_ * target_w_,
-                    channels[c].data,
-                    target_h_ * target_w_ * sizeof(float));
+        for (size_t i = 0; i < end - begin; ++i) {
+            results.push_back(decoder_.decode(outputs + i * per_image_size, per_image_size,
+                                              batch_ratios_[i], score_threshold_, nms_threshold_));
+        }
     }
 
-    return {input_data, r};
+    return results;
 }
 
-std::vector<Detection> YOLOXDetector::postprocess(std::vector<Ort::Value>& output_tensors) {
-    ScopedTimer timer("detection_postprocess");
-
-    auto output_shape = output_tensors[0].GetTensorTypeAndShapeInfo().GetShape();
-
-    size_t output_size = 1;
-    for (auto dim : output_shape) {
-        output_size *= dim;
-    }
-    std::vector<float> output_data_fp32;
+std::vector<Ort::Value> YOLOXDetector::preprocess(const cv::Mat& input) {
+    ScopedTimer timer("detection_preprocess");
 
     if (is_fp16_) {
-        // Convert FP16 output to FP32
-        Ort::Float16_t* output_data_fp16 = output_tensors[0].GetTensorMutableData<Ort::Float16_t>();
-        output_data_fp32.resize(output_size);
-        for (size_t i = 0; i < output_size; ++i) {
-            output_data_fp32[i] = static_cast<float>(output_data_fp16[i]);
-        }
-        return postprocessOutputs(output_data_fp32.data(), output_size, ratio_, score_threshold_, nms_threshold_);
+        input_data_fp16_.resize(letterbox_.getImageSize());
     } else {
-        float* output_data = output_tensors[0].GetTensorMutableData<float>();
-        return postprocessOutputs(output_data, output_size, ratio_, score_threshold_, nms_threshold_);
+        input_data_fp32_.resize(letterbox_.getImageSize());
     }
-}
+    ratio_ = preprocessImage(input, 0);
 
-std::vector<Detection> YOLOXDetector::postprocessOutputs(const float* outputs, size_t output_size,
-                                                          float ratio, float score_threshold,
-                                                          float nms_threshold) {
-    std::vector<int> strides = {8, 16, 32};
-    std::vector<std::pair<int, int>> grid_sizes;
-    std::vector<std::vector<std::pair<float, float>>> grids;
-    std::vector<std::vector<float>> expanded_strides;
-
-    for (int stride : strides) {
-        int hsize = target_h_ / stride;
-        int wsize = target_w_ / stride;
-
-        std::vector<std::pair<float, float>> grid;
-        std::vector<float> strides_vec;
-
-        for (int y = 0; y < hsize; ++y) {
-            for (int x = 0; x < wsize; ++x) {
-                grid.push_back({static_cast<float>(x), static_cast<float>(y)});
-                strides_vec.push_back(static_cast<float>(stride));
-            }
-        }
+    return createInputTensor(1);
+}
 
-        grids.push_back(grid);
-        expanded_strides.push_back(strides_vec);
-    }
+std::vector<Ort::Value> YOLOXDetector::preprocessBatch(const std::vector<cv::Mat>& images, size_t begin, size_t end) {
+    ScopedTimer timer("detection_preprocess");
 
-    std::vector<std::pair<float, float>> all_grids;
-    std::vector<float> all_strides;
+    // Fixed-batch models always receive their full exported batch, so the tail chunk is padded
+    int64_t batch_size = has_dynamic_batch_ ? static_cast<int64_t>(end - begin) : max_batch_size_;
+    size_t image_size = letterbox_.getImageSize();
+    size_t used = (end - begin) * image_size;
 
-    for (size_t i = 0; i < grids.size(); ++i) {
-        all_grids.insert(all_grids.end(), grids[i].begin(), grids[i].end());
-        all_strides.insert(all_strides.end(), expanded_strides[i].begin(), expanded_strides[i].end());
+    // Only the buffer matching the model's input type is filled; the other one stays empty
+    if (is_fp16_) {
+        input_data_fp16_.resize(batch_size * image_size);
+    } else {
+        input_data_fp32_.resize(batch_size * image_size);
     }
+    batch_ratios_.resize(end - begin);
 
-    size_t num_predictions = all_grids.size();
-    size_t num_attrs = 85;  // 4 (bbox) + 1 (objectness) + 80 (classes) -> this is coco default
-
-    std::vector<float> boxes;
-    std::vector<std::vector<float>> scores;
-
-    for (size_t i = 0; i < num_predictions; ++i) {
-        size_t idx = i * num_attrs;
-
-        float cx = (outputs[idx] + all_grids[i].first) * all_strides[i];
-        float cy = (outputs[idx + 1] + all_grids[i].second) * all_strides[i];
-
-        float w = std::exp(outputs[idx + 2]) * all_strides[i];
-        float h = std::exp(outputs[idx + 3]) * all_strides[i];
-
-        boxes.push_back(cx);
-        boxes.push_back(cy);
-        boxes.push_back(w);
-        boxes.push_back(h);
+    for (size_t i = begin; i < end; ++i) {
+        batch_ratios_[i - begin] = preprocessImage(images[i], i - begin);
+    }
 
-        float objectness = outputs[idx + 4];
-        std::vector<float> class_scores;
-        for (size_t c = 0; c < 80; ++c) {
-            class_scores.push_back(objectness * outputs[idx + 5 + c]);
-        }
-        scores.push_back(class_scores);
+    if (is_fp16_) {
+        letterbox_.fillPadding(reinterpret_cast<uint16_t*>(input_data_fp16_.data()) + used, input_data_fp16_.size() - used);
+    } else {
+        letterbox_.fillPadding(input_data_fp32_.data() + used, input_data_fp32_.size() - used);
     }
 
-    xywh_to_xyxy(boxes, ratio);
-    return multiclass_nms_class_agnostic(boxes, scores, nms_threshold, score_threshold);
+    return createInputTensor(batch_size);
 }
 
-void YOLOXDetector::xywh_to_xyxy(std::vector<float>& boxes, float ratio) {
-    for (size_t i = 0; i < boxes.size(); i += 4) {
-        float cx = boxes[i];
-        float cy = boxes[i + 1];
-        float w = boxes[i + 2];
-        float h = boxes[i + 3];
-
-        boxes[i] = (cx - w / 2.0f) / ratio;
-        boxes[i + 1] = (cy - h / 2.0f) / ratio;
-        boxes[i + 2] = (cx + w / 2.0f) / ratio;
-        boxes[i + 3] = (cy + h / 2.0f) / ratio;
-    }
-}
+std::vector<Ort::Value> YOLOXDetector::createInputTensor(int64_t batch_size) {
+    std::vector<int64_t> input_shape = {batch_size, 3, target_h_, target_w_};
+    std::vector<Ort::Value> tensors;
 
-std::vector<int> YOLOXDetector::nms(const std::vector<float>& boxes, const std::vector<float>& scores,
-                                     float nms_thr) {
-    std::vector<int> indices(scores.size());
-    std::iota(indices.begin(), indices.end(), 0);
-
-    std::sort(indices.begin(), indices.end(), [&scores](int i1, int i2) {
-        return scores[i1] > scores[i2];
-    });
-
-    std::vector<float> areas(scores.size());
-    for (size_t i = 0; i < scores.size(); ++i) {
-        float x1 = boxes[i * 4];
-        float y1 = boxes[i * 4 + 1];
-        float x2 = boxes[i * 4 + 2];
-        float y2 = boxes[i * 4 + 3];
-        areas[i] = (x2 - x1 + 1) * (y2 - y1 + 1);
+    if (is_fp16_) {
+        auto tensor = Ort::Value::CreateTensor<Ort::Float16_t>(
+            memory_info_,
+            input_data_fp16_.data(),
+            input_data_fp16_.size(),
+            input_shape.data(),
+            input_shape.size()
+        );
+        tensors.push_back(std::move(tensor));
+    } else {
+        auto tensor = Ort::Value::CreateTensor<float>(
+            memory_info_,
+            input_data_fp32_.data(),
+            input_data_fp32_.size(),
+            input_shape.data(),
+            input_shape.size()
+        );
+        tensors.push_back(std::move(tensor));
     }
 
-    std::vector<int> keep;
-    while (!indices.empty()) {
-        int idx = indices[0];
-        keep.push_back(idx);
-
-        if (indices.size() == 1) break;
-
-        std::vector<int> new_indices;
-        for (size_t i = 1; i < indices.size(); ++i) {
-            int idx2 = indices[i];
-
-            float x1 = std::max(boxes[idx * 4], boxes[idx2 * 4]);
-            float y1 = std::max(boxes[idx * 4 + 1], boxes[idx2 * 4 + 1]);
-            float x2 = std::min(boxes[idx * 4 + 2], boxes[idx2 * 4 + 2]);
-            float y2 = std::min(boxes[idx * 4 + 3], boxes[idx2 * 4 + 3]);
-
-            float w = std::max(0.0f, x2 - x1 + 1);
-            float h = std::max(0.0f, y2 - y1 + 1);
-            float inter = w * h;
-
-            float iou = inter / (areas[idx] + areas[idx2] - inter);
-
-            if (iou <= nms_thr) {
-                new_indices.push_back(idx2);
-            }
-        }
+    return tensors;
+}
 
-        indices = new_indices;
+float YOLOXDetector::preprocessImage(const cv::Mat& ori_frame, size_t slot) {
+    size_t offset = slot * letterbox_.getImageSize();
+    if (is_fp16_) {
+        static_assert(sizeof(Ort::Float16_t) == sizeof(uint16_t), "Ort::Float16_t must be a plain IEEE half");
+        return letterbox_.run(ori_frame, reinterpret_cast<uint16_t*>(input_data_fp16_.data()) + offset);
     }
-
-    return keep;
+    return letterbox_.run(ori_frame, input_data_fp32_.data() + offset);
 }
 
-std::vector<Detection> YOLOXDetector::multiclass_nms_class_agnostic(const std::vector<float>& boxes,
-                                                                     const std::vector<std::vector<float>>& scores,
-                                                                     float nms_thr, float score_thr) {
-    size_t num_boxes = scores.size();
-    std::vector<int> cls_inds;
-    std::vector<float> cls_scores;
+const float* YOLOXDetector::outputAsFloat(Ort::Value& output_tensor, size_t& output_size) {
+    auto output_shape = output_tensor.GetTensorTypeAndShapeInfo().GetShape();
 
-    for (const auto& score_vec : scores) {
-        auto max_it = std::max_element(score_vec.begin(), score_vec.end());
-        int cls_idx = std::distance(score_vec.begin(), max_it);
-        float max_score = *max_it;
-
-        cls_inds.push_back(cls_idx);
-        cls_scores.push_back(max_score);
+    output_size = 1;
+    for (auto dim : output_shape) {
+        output_size *= dim;
     }
 
-    std::vector<float> valid_boxes;
-    std::vector<float> valid_scores;
-    std::vector<int> valid_cls_inds;
-
-    for (size_t i = 0; i < num_boxes; ++i) {
-        if (cls_scores[i] > score_thr) {
-            valid_boxes.push_back(boxes[i * 4]);
-            valid_boxes.push_back(boxes[i * 4 + 1]);
-            valid_boxes.push_back(boxes[i * 4 + 2]);
-            valid_boxes.push_back(boxes[i * 4 + 3]);
-            valid_scores.push_back(cls_scores[i]);
-            valid_cls_inds.push_back(cls_inds[i]);
-        }
+    if (!is_fp16_) {
+        return output_tensor.GetTensorMutableData<float>();
     }
 
-    if (valid_scores.empty()) {
-        return std::vector<Detection>();
+    // Convert FP16 output to FP32
+    Ort::Float16_t* output_data_fp16 = output_tensor.GetTensorMutableData<Ort::Float16_t>();
+    output_data_fp32_.resize(output_size);
+    for (size_t i = 0; i < output_size; ++i) {
+        output_data_fp32_[i] = static_cast<float>(output_data_fp16[i]);
     }
+    return output_data_fp32_.data();
+}
 
-    std::vector<int> keep = nms(valid_boxes, valid_scores, nms_thr);
-
-    std::vector<Detection> detections;
-    for (int idx : keep) {
-        if(std::find(this->classes_.begin(), this->classes_.end(), valid_cls_inds[idx]) == this->classes_.end())
-        {
-            continue;
-        }
-        
-        Detection det;
-        det.x1 = valid_boxes[idx * 4];
-        det.y1 = valid_boxes[idx * 4 + 1];
-        det.x2 = valid_boxes[idx * 4 + 2];
-        det.y2 = valid_boxes[idx * 4 + 3];
-        det.score = valid_scores[idx];
-        det.class_id = valid_cls_inds[idx];
-        detections.push_back(det);
-    }
+std::vector<Detection> YOLOXDetector::postprocess(std::vector<Ort::Value>& output_tensors) {
+    ScopedTimer timer("detection_postprocess");
 
-    return detections;
+    size_t output_size = 0;
+    const float* outputs = outputAsFloat(output_tensors[0], output_size);
+    return decoder_.decode(outputs, output_size, ratio_, score_threshold_, nms_threshold_);
 }
+
 }
@@ -1,11 +1,32 @@
 #include "../../../lib/catch2/catch_amalgamated.hpp"
 #include "yolox_detector.hpp"
+#include "letterbox_preprocessor.hpp"
+#include "yolox_decoder.hpp"
+#include "nms.hpp"
+#include "../../../common/include/model_pool.hpp"
+#include <cmath>
+#include <numeric>
 #include <opencv2/opencv.hpp>
+#include <thread>
 
 namespace nl_video_analysis
 {
     const std::string TEST_MODEL_PATH = "/home/nvidia/projects/NaturalLanguage-VisionAnalysis/weights/yolox_m.onnx";
 
+    // Same boxes, scores and classes in the same order
+    static void requireSameDetections(const std::vector<Detection>& actual, const std::vector<Detection>& expected)
+    {
+        REQUIRE(actual.size() == expected.size());
+        for (size_t i = 0; i < expected.size(); ++i) {
+            REQUIRE(actual[i].class_id == expected[i].class_id);
+            REQUIRE(actual[i].score == Catch::Approx(expected[i].score));
+            REQUIRE(actual[i].x1 == Catch::Approx(expected[i].x1));
+            REQUIRE(actual[i].y1 == Catch::Approx(expected[i].y1));
+            REQUIRE(actual[i].x2 == Catch::Approx(expected[i].x2));
+            REQUIRE(actual[i].y2 == Catch::Approx(expected[i].y2));
+        }
+    }
+
     TEST_CASE("Model loading")
     {
         SECTION("Model loads correctly with valid path")
@@ -66,6 +87,112 @@ namespace nl_video_analysis
         }
     }
 
+    TEST_CASE("Batched detection")
+    {
+        YOLOXDetector detector(TEST_MODEL_PATH, 2, false, {0}, 4);
+        std::vector<cv::Mat> frames;
+        for (int i = 0; i < 6; ++i) {
+            frames.emplace_back(480, 640, CV_8UC3, cv::Scalar(20 * i, 128, 128));
+        }
+
+        SECTION("Returns one result per frame")
+        {
+            auto results = detector.detectBatch(frames);
+            REQUIRE(results.size() == frames.size());
+        }
+
+        SECTION("Matches per-frame detection")
+        {
+            auto results = detector.detectBatch(frames, 0.1f, 0.45f);
+            for (size_t i = 0; i < frames.size(); ++i) {
+                requireSameDetections(results[i], detector.detect(frames[i], 0.1f, 0.45f));
+            }
+        }
+
+        SECTION("Empty batch returns nothing")
+        {
+            REQUIRE(detector.detectBatch({}).empty());
+        }
+    }
+
+    TEST_CASE("IoBinding inference")
+    {
+        YOLOXDetector detector(TEST_MODEL_PATH, 2, false, {0}, 4);
+        std::vector<cv::Mat> frames;
+        for (int i = 0; i < 5; ++i) {
+            frames.emplace_back(480, 640, CV_8UC3, cv::Scalar(30 * i, 128, 128));
+        }
+        auto expected = detector.detectBatch(frames, 0.1f, 0.45f);
+
+        detector.setIoBinding(true);
+        REQUIRE(detector.usesIoBinding());
+
+        SECTION("Matches regular inference across batch size changes")
+        {
+            // Chunks of 4 and 1 frames rebind the outputs in between
+            for (int run = 0; run < 2; ++run) {
+                auto results = detector.detectBatch(frames, 0.1f, 0.45f);
+                REQUIRE(results.size() == expected.size());
+                for (size_t i = 0; i < frames.size(); ++i) {
+                    requireSameDetections(results[i], expected[i]);
+                }
+            }
+        }
+
+        SECTION("Can be switched off again")
+        {
+            detector.setIoBinding(false);
+            REQUIRE_FALSE(detector.usesIoBinding());
+            REQUIRE(detector.detectBatch(frames, 0.1f, 0.45f).size() == frames.size());
+        }
+    }
+
+    TEST_CASE("Shared session contexts")
+    {
+        YOLOXDetector reference(TEST_MODEL_PATH, 2, false, {0}, 4);
+        std::vector<cv::Mat> frames;
+        for (int i = 0; i < 4; ++i) {
+            frames.emplace_back(480, 640, CV_8UC3, cv::Scalar(40 * i, 128, 128));
+        }
+        auto expected = reference.detectBatch(frames, 0.1f, 0.45f);
+
+        ModelPool<YOLOXDetector> pool(3, [&](size_t) {
+            return std::make_unique<YOLOXDetector>(reference.getSession(), false, std::vector<int>{0}, 4);
+        });
+
+        SECTION("Contexts share the session")
+        {
+            auto first = pool.acquire();
+            auto second = pool.acquire();
+            REQUIRE(first.index() != second.index());
+            REQUIRE(first->getSession() == second->getSession());
+            REQUIRE(pool.available() == 1);
+        }
+
+        SECTION("Concurrent inference matches sequential inference")
+        {
+            std::vector<std::vector<std::vector<Detection>>> results(6);
+            std::vector<std::thread> threads;
+            for (size_t t = 0; t < results.size(); ++t) {
+                threads.emplace_back([&, t] {
+                    auto detector = pool.acquire();
+                    results[t] = detector->detectBatch(frames, 0.1f, 0.45f);
+                });
+            }
+            for (auto& thread : threads) {
+                thread.join();
+            }
+
+            REQUIRE(pool.available() == pool.size());
+            for (const auto& result : results) {
+                REQUIRE(result.size() == expected.size());
+                for (size_t i = 0; i < expected.size(); ++i) {
+                    requireSameDetections(result[i], expected[i]);
+                }
+            }
+        }
+    }
+
     TEST_CASE("Edge cases")
     {
         YOLOXDetector detector(TEST_MODEL_PATH, 2, false, {0});
@@ -85,4 +212,264 @@ namespace nl_video_analysis
             REQUIRE_NOTHROW(detector.detect(large));
         }
     }
+    // Reference letterbox: pad, resize into the top-left corner, then planar float copy
+    static std::vector<float> referenceLetterbox(const cv::Mat& frame, int target_w, int target_h, float& ratio)
+    {
+        cv::Mat padded(target_h, target_w, CV_8UC3, cv::Scalar(114, 114, 114));
+        ratio = std::min(static_cast<float>(target_h) / frame.rows, static_cast<float>(target_w) / frame.cols);
+        cv::Mat resized;
+        cv::resize(frame, resized, cv::Size(static_cast<int>(frame.cols * ratio), static_cast<int>(frame.rows * ratio)),
+                   0, 0, cv::INTER_LINEAR);
+        resized.copyTo(padded(cv::Rect(0, 0, resized.cols, resized.rows)));
+
+        std::vector<float> planar(3 * target_h * target_w);
+        for (int y = 0; y < target_h; ++y) {
+            for (int x = 0; x < target_w; ++x) {
+                const cv::Vec3b& pixel = padded.at<cv::Vec3b>(y, x);
+                for (int c = 0; c < 3; ++c) {
+                    planar[(c * target_h + y) * target_w + x] = pixel[c];
+                }
+            }
+        }
+        return planar;
+    }
+
+    TEST_CASE("Fused letterbox preprocessing")
+    {
+        const int target_w = 96;
+        const int target_h = 64;
+        LetterboxPreprocessor letterbox(target_w, target_h);
+        std::vector<float> fp32(letterbox.getImageSize());
+        std::vector<uint16_t> fp16(letterbox.getImageSize());
+
+        SECTION("Matches the reference for landscape, portrait and exact-size frames")
+        {
+            for (cv::Size size : {cv::Size(200, 90), cv::Size(50, 120), cv::Size(target_w, target_h), cv::Size(37, 23)}) {
+                cv::Mat frame(size, CV_8UC3);
+                cv::randu(frame, cv::Scalar::all(0), cv::Scalar::all(256));
+
+                float expected_ratio = 0.0f;
+                auto expected = referenceLetterbox(frame, target_w, target_h, expected_ratio);
+
+                REQUIRE(letterbox.run(frame, fp32.data()) == expected_ratio);
+                REQUIRE(fp32 == expected);
+
+                REQUIRE(letterbox.run(frame, fp16.data()) == expected_ratio);
+                for (size_t i = 0; i < expected.size(); ++i) {
+                    REQUIRE(fp16[i] == LetterboxPreprocessor::fp16Table()[static_cast<int>(expected[i])]);
+                }
+            }
+        }
+
+        SECTION("fp16 table holds the IEEE half encodings of 0..255")
+        {
+            const auto& table = LetterboxPreprocessor::fp16Table();
+            REQUIRE(table[0] == 0x0000);
+            REQUIRE(table[1] == 0x3C00);
+            REQUIRE(table[2] == 0x4000);
+            REQUIRE(table[114] == 0x5720);
+            REQUIRE(table[255] == 0x5BF8);
+            for (int i = 1; i < 256; ++i) {
+                REQUIRE(table[i] > table[i - 1]);
+            }
+        }
+
+        SECTION("Padding fills the unused area")
+        {
+            cv::Mat frame(32, 96, CV_8UC3, cv::Scalar(1, 2, 3));
+            letterbox.run(frame, fp32.data());
+            // The frame fills the top half at ratio 1, the bottom half is padding
+            REQUIRE(fp32[0] == 1.0f);
+            REQUIRE(fp32[target_w * target_h] == 2.0f);
+            REQUIRE(fp32[2 * target_w * target_h] == 3.0f);
+            REQUIRE(fp32[(target_h - 1) * target_w] == 114.0f);
+
+            std::vector<uint16_t> tail(10);
+            letterbox.fillPadding(tail.data(), tail.size());
+            for (uint16_t value : tail) {
+                REQUIRE(value == LetterboxPreprocessor::fp16Table()[114]);
+            }
+        }
+
+        SECTION("Rejects empty and non-BGR frames")
+        {
+            REQUIRE_THROWS_AS(letterbox.run(cv::Mat(), fp32.data()), std::invalid_argument);
+            REQUIRE_THROWS_AS(letterbox.run(cv::Mat(10, 10, CV_8UC1), fp32.data()), std::invalid_argument);
+        }
+    }
+    TEST_CASE("YOLOX output decoding")
+    {
+        // 64x64 input: 8x8 + 4x4 + 2x2 anchors of 85 attributes
+        std::vector<int> all_classes(80);
+        std::iota(all_classes.begin(), all_classes.end(), 0);
+        std::vector<float> outputs(84 * 85, 0.0f);
+
+        // Anchor 9 is cell (1, 1) of the stride 8 head; a 32x32 box centred on (8, 8)
+        float* best = outputs.data() + 9 * 85;
+        best[2] = std::log(4.0f);
+        best[3] = std::log(4.0f);
+        best[4] = 0.9f;
+        best[5 + 3] = 0.8f;
+        best[5 + 7] = 0.8f;
+        best[5 + 1] = 0.5f;
+
+        // Its neighbour overlaps it with a lower score
+        float* neighbour = outputs.data() + 10 * 85;
+        neighbour[2] = std::log(4.0f);
+        neighbour[3] = std::log(4.0f);
+        neighbour[4] = 0.9f;
+        neighbour[5 + 1] = 0.6f;
+
+        SECTION("Grids are built for the three heads")
+        {
+            YOLOXDecoder decoder(all_classes);
+            decoder.configure(64, 64, 80);
+            REQUIRE(decoder.getNumAnchors() == 84);
+            REQUIRE(decoder.getNumAttributes() == 85);
+        }
+
+        SECTION("Decodes, rescales and suppresses overlapping boxes")
+        {
+            YOLOXDecoder decoder(all_classes);
+            decoder.configure(64, 64, 80);
+            auto detections = decoder.decode(outputs.data(), outputs.size(), 0.5f, 0.25f, 0.45f);
+
+            REQUIRE(detections.size() == 1);
+            REQUIRE(detections[0].class_id == 3);
+            REQUIRE(detections[0].score == Catch::Approx(0.72f));
+            REQUIRE(detections[0].x1 == Catch::Approx(-16.0f));
+            REQUIRE(detections[0].y1 == Catch::Approx(-16.0f));
+            REQUIRE(detections[0].x2 == Catch::Approx(48.0f));
+            REQUIRE(detections[0].y2 == Catch::Approx(48.0f));
+        }
+
+        SECTION("Scores only the configured classes")
+        {
+            YOLOXDecoder decoder({1});
+            decoder.configure(64, 64, 80);
+            auto detections = decoder.decode(outputs.data(), outputs.size(), 1.0f, 0.25f, 0.45f);
+
+            REQUIRE(detections.size() == 1);
+            REQUIRE(detections[0].class_id == 1);
+            REQUIRE(detections[0].score == Catch::Approx(0.54f));
+        }
+
+        SECTION("Low objectness is filtered before scoring")
+        {
+            YOLOXDecoder decoder(all_classes);
+            decoder.configure(64, 64, 80);
+            REQUIRE(decoder.decode(outputs.data(), outputs.size(), 1.0f, 0.95f, 0.45f).empty());
+        }
+
+        SECTION("Custom class counts and strides")
+        {
+            // Two-class model with P3-P6 heads on a 128x96 input
+            YOLOXDecoder decoder({0, 1, 5});
+            decoder.configure(128, 96, 2, {8, 16, 32, 64});
+            REQUIRE(decoder.getNumAnchors() == YOLOXDecoder::countAnchors(128, 96, {8, 16, 32, 64}));
+            REQUIRE(decoder.getNumAnchors() == 192 + 48 + 12 + 2);
+            REQUIRE(decoder.getNumAttributes() == 7);
+            REQUIRE(decoder.getClasses() == std::vector<int>{0, 1});
+
+            std::vector<float> small(decoder.getNumAnchors() * 7, 0.0f);
+            // Anchor 252 is cell (0, 0) of the stride 64 head
+            float* row = small.data() + 252 * 7;
+            row[4] = 0.8f;
+            row[6] = 0.9f;
+            auto detections = decoder.decode(small.data(), small.size(), 1.0f, 0.25f, 0.45f);
+            REQUIRE(detections.size() == 1);
+            REQUIRE(detections[0].class_id == 1);
+            REQUIRE(detections[0].x1 == Catch::Approx(-32.0f));
+            REQUIRE(detections[0].x2 == Catch::Approx(32.0f));
+        }
+
+        SECTION("Rejects invalid layouts")
+        {
+            YOLOXDecoder decoder(all_classes);
+            REQUIRE_THROWS_AS(decoder.configure(64, 64, 0), std::invalid_argument);
+            REQUIRE_THROWS_AS(decoder.configure(64, 64, 80, {}), std::invalid_argument);
+            REQUIRE_THROWS_AS(decoder.configure(64, 64, 80, {8, 0}), std::invalid_argument);
+        }
+
+        SECTION("No configured class decodes nothing")
+        {
+            YOLOXDecoder decoder(std::vector<int>{});
+            decoder.configure(64, 64, 80);
+            REQUIRE(decoder.decode(outputs.data(), outputs.size(), 1.0f, 0.25f, 0.45f).empty());
+        }
+    }
+    TEST_CASE("NMS engine")
+    {
+        // Boxes 0 and 1 overlap heavily, box 2 is apart, box 3 overlaps box 2 a little
+        std::vector<float> boxes = {
+            0, 0, 99, 99,
+            5, 5, 104, 104,
+            200, 200, 299, 299,
+            280, 280, 379, 379,
+        };
+        std::vector<float> scores = {0.6f, 0.9f, 0.8f, 0.7f};
+        NmsEngine engine;
+
+        SECTION("Keeps the best box of each cluster, highest score first")
+        {
+            const auto& keep = engine.run(boxes.data(), scores.data(), nullptr, scores.size(), 0.45f);
+            REQUIRE(keep == std::vector<int>{1, 2, 3});
+        }
+
+        SECTION("Boxes only suppress boxes of their own group")
+        {
+            std::vector<int> groups = {0, 1, 0, 0};
+            const auto& keep = engine.run(boxes.data(), scores.data(), groups.data(), scores.size(), 0.45f);
+            REQUIRE(keep == std::vector<int>{1, 2, 3, 0});
+        }
+
+        SECTION("Stops after max_kept boxes")
+        {
+            const auto& keep = engine.run(boxes.data(), scores.data(), nullptr, scores.size(), 0.45f, 2);
+            REQUIRE(keep == std::vector<int>{1, 2});
+        }
+
+        SECTION("Matches a scalar reference on dense scenes")
+        {
+            cv::RNG rng(7);
+            std::vector<float> dense_boxes;
+            std::vector<float> dense_scores;
+            for (int i = 0; i < 300; ++i) {
+                float x = rng.uniform(0.0f, 200.0f);
+                float y = rng.uniform(0.0f, 200.0f);
+                dense_boxes.insert(dense_boxes.end(), {x, y, x + rng.uniform(10.0f, 60.0f), y + rng.uniform(10.0f, 60.0f)});
+                dense_scores.push_back(rng.uniform(0.0f, 1.0f));
+            }
+
+            std::vector<int> order(dense_scores.size());
+            std::iota(order.begin(), order.end(), 0);
+            std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return dense_scores[a] > dense_scores[b]; });
+            auto area = [&](int i) {
+                return (dense_boxes[i * 4 + 2] - dense_boxes[i * 4] + 1) * (dense_boxes[i * 4 + 3] - dense_boxes[i * 4 + 1] + 1);
+            };
+            std::vector<int> expected;
+            for (int i : order) {
+                bool suppressed = false;
+                for (int k : expected) {
+                    float w = std::max(0.0f, std::min(dense_boxes[i * 4 + 2], dense_boxes[k * 4 + 2]) -
+                                             std::max(dense_boxes[i * 4], dense_boxes[k * 4]) + 1);
+                    float h = std::max(0.0f, std::min(dense_boxes[i * 4 + 3], dense_boxes[k * 4 + 3]) -
+                                             std::max(dense_boxes[i * 4 + 1], dense_boxes[k * 4 + 1]) + 1);
+                    float inter = w * h;
+                    suppressed = suppressed || inter > 0.45f * (area(i) + area(k) - inter);
+                }
+                if (!suppressed) {
+                    expected.push_back(i);
+                }
+            }
+
+            const auto& keep = engine.run(dense_boxes.data(), dense_scores.data(), nullptr, dense_scores.size(), 0.45f);
+            REQUIRE(keep == expected);
+        }
+
+        SECTION("No boxes keeps nothing")
+        {
+            REQUIRE(engine.run(nullptr, nullptr, nullptr, 0, 0.45f).empty());
+        }
+    }
 }
\ No newline at end of file
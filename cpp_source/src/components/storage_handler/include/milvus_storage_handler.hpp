@@ -7,6 +7,7 @@
 #include "milvus/types/Constants.h"
 #include "milvus/utils/FP16.h"
 #include <opencv2/opencv.hpp>
+#include <nlohmann/json.hpp>
 #include <filesystem>
 #include <fstream>
 
@@ -24,6 +25,9 @@ namespace nl_video_analysis
         ~MilvusStorageHandler() override;
         std::string saveClip(const ClipContainer& clip, std::map<int64_t, std::vector<std::vector<float>>>& embeddings_map) override;
 
+        // Where a clip that references a recording lives: the file, the offset into it and every segment it spans
+        static nlohmann::json recordingManifest(const ClipContainer& clip);
+
         private:
         bool connectToDatabase();
         std::string saveClipToDisk(const ClipContainer& clip);
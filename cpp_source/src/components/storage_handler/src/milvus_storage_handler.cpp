@@ -83,14 +83,33 @@ std::string MilvusStorageHandler::saveClipToDisk(const ClipContainer& clip) {
         std::filesystem::create_directories(camera_dir);
     }
 
+    // Clips recorded by the stream handler (remuxed segments or the source file) are only referenced. A clip
+    // can span several segments, so the full reference is kept in <clip_id>.json where the clip would be.
+    if (!clip.clip_path.empty()) {
+        std::filesystem::path manifest_path = camera_dir / (clip.clip_id + ".json");
+        std::ofstream manifest(manifest_path);
+        manifest << recordingManifest(clip).dump(2) << std::endl;
+        if (!manifest) {
+            LOG_ERROR("[MilvusStorageHandler] Failed to write recording manifest: {}", manifest_path.string());
+        }
+        return clip.clip_path;
+    }
+
     std::stringstream filename;
     filename << clip.clip_id << ".mp4";
     std::filesystem::path clip_file_path = camera_dir / filename.str();
 
-    if (!clip.frames.empty()) {
-        int frame_width = clip.frames[0].cols;
-        int frame_height = clip.frames[0].rows;
+    // Clips sampled at decode time only carry their sampled frames; those are written at the rate that
+    // preserves the clip duration
+    const std::vector<cv::Mat>& frames = clip.frames.empty() ? clip.sampled_frames : clip.frames;
+
+    if (!frames.empty()) {
+        int frame_width = frames[0].cols;
+        int frame_height = frames[0].rows;
         double fps = 30.0;
+        if (clip.frames.empty() && clip.end_timestamp_ms > clip.start_timestamp_ms) {
+            fps = frames.size() * 1000.0 / (clip.end_timestamp_ms - clip.start_timestamp_ms);
+        }
 
         cv::VideoWriter video_writer(
             clip_file_path.string(),
@@ -104,7 +123,7 @@ std::string MilvusStorageHandler::saveClipToDisk(const ClipContainer& clip) {
             return "";
         }
 
-        for (const auto& frame : clip.frames) {
+        for (const auto& frame : frames) {
             video_writer.write(frame);
         }
 
@@ -116,6 +135,40 @@ std::string MilvusStorageHandler::saveClipToDisk(const ClipContainer& clip) {
     return "";
 }
 
+nlohmann::json MilvusStorageHandler::recordingManifest(const ClipContainer& clip) {
+    // Newline-separated (see RecordingSegments::join), so paths may hold commas
+    std::vector<std::string> segments;
+    auto it = clip.metadata.find("segments");
+    if (it != clip.metadata.end()) {
+        std::stringstream list(it->second);
+        std::string segment;
+        while (std::getline(list, segment, '\n')) {
+            if (!segment.empty()) {
+                segments.push_back(segment);
+            }
+        }
+    }
+    if (segments.empty()) {
+        segments.push_back(clip.clip_path);
+    }
+
+    uint64_t offset_ms = 0;
+    it = clip.metadata.find("segment_offset_ms");
+    if (it != clip.metadata.end()) {
+        offset_ms = std::stoull(it->second);
+    }
+
+    return {
+        {"clip_id", clip.clip_id},
+        {"camera_id", clip.camera_id},
+        {"start_timestamp_ms", clip.start_timestamp_ms},
+        {"end_timestamp_ms", clip.end_timestamp_ms},
+        {"clip_path", clip.clip_path},
+        {"segment_offset_ms", offset_ms},
+        {"segments", segments},
+    };
+}
+
 std::string MilvusStorageHandler::saveClip(const ClipContainer& clip, std::map<int64_t, std::vector<std::vector<float>>>& embeddings_map) {
     if (!is_connected_) {
         LOG_INFO("[MilvusStorageHandler] Not connected to database, attempting to reconnect...");
@@ -0,0 +1,50 @@
+#define CATCH_CONFIG_MAIN
+#include "../../../lib/catch2/catch_amalgamated.hpp"
+#include "milvus_storage_handler.hpp"
+#include "../../stream_handler/include/recording_segments.hpp"
+
+using namespace nl_video_analysis;
+
+static ClipContainer referencedClip(const std::string& clip_path) {
+    ClipContainer clip("clip_42", "cam,lobby", std::vector<cv::Mat>{}, 10000, 15000);
+    clip.clip_path = clip_path;
+    return clip;
+}
+
+TEST_CASE("Recording manifest of an RTSP clip spanning segments", "[storage_handler]") {
+    // Commas in the storage path and camera id must not split a segment
+    const std::vector<std::string> paths = {"/data/clips,2024/cam,lobby/segment_00007.mp4",
+                                            "/data/clips,2024/cam,lobby/segment_00008.mp4"};
+    ClipContainer clip = referencedClip(paths[0]);
+    clip.metadata["segments"] = RecordingSegments::join(paths);
+    clip.metadata["segment_offset_ms"] = "3900";
+
+    nlohmann::json manifest = MilvusStorageHandler::recordingManifest(clip);
+    REQUIRE(manifest["clip_id"] == "clip_42");
+    REQUIRE(manifest["camera_id"] == "cam,lobby");
+    REQUIRE(manifest["start_timestamp_ms"] == 10000);
+    REQUIRE(manifest["end_timestamp_ms"] == 15000);
+    REQUIRE(manifest["clip_path"] == paths[0]);
+    REQUIRE(manifest["segment_offset_ms"] == 3900);
+    REQUIRE(manifest["segments"].get<std::vector<std::string>>() == paths);
+}
+
+TEST_CASE("Recording manifest of a file clip", "[storage_handler]") {
+    const std::string source = "/videos/2024-05-01, entrance.mp4";
+    ClipContainer clip = referencedClip(source);
+    clip.metadata["segments"] = source;
+    clip.metadata["segment_offset_ms"] = "10000";
+
+    nlohmann::json manifest = MilvusStorageHandler::recordingManifest(clip);
+    REQUIRE(manifest["segments"].get<std::vector<std::string>>() == std::vector<std::string>{source});
+    REQUIRE(manifest["segment_offset_ms"] == 10000);
+}
+
+TEST_CASE("Recording manifest without segment metadata", "[storage_handler]") {
+    ClipContainer clip = referencedClip("/data/clips/cam/segment_00001.mp4");
+
+    nlohmann::json manifest = MilvusStorageHandler::recordingManifest(clip);
+    REQUIRE(manifest["segments"].get<std::vector<std::string>>() ==
+            std::vector<std::string>{"/data/clips/cam/segment_00001.mp4"});
+    REQUIRE(manifest["segment_offset_ms"] == 0);
+}
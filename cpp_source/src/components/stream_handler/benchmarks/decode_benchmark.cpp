@@ -0,0 +1,155 @@
+// Decode throughput benchmark for the GStreamer decode backends.
+// Runs N identical decode pipelines over a local MP4 file per backend and reports, per stream, how many
+// seconds of video were decoded per wall-clock second. A realtime factor of 4x means one stream of that
+// backend keeps up with four live cameras at the configured resolution and frame rate.
+
+#include "gst_pipeline_builder.hpp"
+#include <gst/app/gstappsink.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace nl_video_analysis;
+
+struct StreamResult {
+    size_t frames = 0;
+    double video_seconds = 0.0;
+    bool failed = false;
+};
+
+static void runStream(const std::string& description, double max_seconds, StreamResult& result) {
+    GError* error = nullptr;
+    GstElement* pipeline = gst_parse_launch(description.c_str(), &error);
+    if (!pipeline || error) {
+        std::cerr << "Pipeline failed: " << (error ? error->message : "Unknown") << std::endl;
+        if (error) g_error_free(error);
+        result.failed = true;
+        return;
+    }
+
+    GstElement* sink = gst_bin_get_by_name(GST_BIN(pipeline), "sink");
+    // Keep every buffer so the frame count reflects decoded frames, not appsink drops
+    g_object_set(sink, "emit-signals", FALSE, "drop", FALSE, nullptr);
+    gst_element_set_state(pipeline, GST_STATE_PLAYING);
+
+    auto start = std::chrono::steady_clock::now();
+    GstClockTime first_pts = GST_CLOCK_TIME_NONE;
+    GstClockTime last_pts = GST_CLOCK_TIME_NONE;
+
+    while (std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() < max_seconds) {
+        GstSample* sample = gst_app_sink_try_pull_sample(GST_APP_SINK(sink), GST_SECOND);
+        if (!sample) {
+            if (gst_app_sink_is_eos(GST_APP_SINK(sink))) {
+                break;
+            }
+            continue;
+        }
+
+        GstBuffer* buffer = gst_sample_get_buffer(sample);
+        if (buffer && GST_BUFFER_PTS_IS_VALID(buffer)) {
+            if (!GST_CLOCK_TIME_IS_VALID(first_pts)) {
+                first_pts = GST_BUFFER_PTS(buffer);
+            }
+            last_pts = GST_BUFFER_PTS(buffer);
+        }
+        result.frames++;
+        gst_sample_unref(sample);
+    }
+
+    if (GST_CLOCK_TIME_IS_VALID(first_pts)) {
+        result.video_seconds = static_cast<double>(last_pts - first_pts) / GST_SECOND;
+    }
+
+    gst_element_set_state(pipeline, GST_STATE_NULL);
+    gst_object_unref(sink);
+    gst_object_unref(pipeline);
+}
+
+static void benchmarkBackend(DecodeBackend backend, DecodePipelineOptions options, int streams, double max_seconds) {
+    options.backend = backend;
+    std::string description = GstPipelineBuilder::build(options);
+
+    std::vector<StreamResult> results(streams);
+    std::vector<std::thread> threads;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < streams; ++i) {
+        threads.emplace_back(runStream, description, max_seconds, std::ref(results[i]));
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    double wall_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    size_t total_frames = 0;
+    double total_video_seconds = 0.0;
+    double min_realtime = 0.0;
+    for (size_t i = 0; i < results.size(); ++i) {
+        if (results[i].failed) {
+            std::cout << "  " << GstPipelineBuilder::backendName(backend) << ": stream " << i << " failed" << std::endl;
+            return;
+        }
+        double realtime = results[i].video_seconds / wall_seconds;
+        min_realtime = (i == 0) ? realtime : std::min(min_realtime, realtime);
+        total_frames += results[i].frames;
+        total_video_seconds += results[i].video_seconds;
+    }
+
+    std::cout << std::fixed << std::setprecision(2)
+              << "  " << std::setw(8) << GstPipelineBuilder::backendName(backend)
+              << " | streams " << streams
+              << " | " << std::setw(8) << total_frames / wall_seconds / streams << " fps/stream"
+              << " | " << std::setw(6) << total_video_seconds / wall_seconds / streams << "x realtime/stream"
+              << " (slowest " << min_realtime << "x)"
+              << " | " << std::setw(8) << total_frames / wall_seconds << " fps total" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <video.mp4> [h264|h265] [streams=1] [threads=0] [seconds=30]"
+                  << " [width=640] [height=640] [fps=30]" << std::endl;
+        return 1;
+    }
+
+    gst_init(&argc, &argv);
+
+    DecodePipelineOptions options;
+    options.source_url = argv[1];
+    options.codec = (argc > 2 && std::strcmp(argv[2], "h265") == 0) ? StreamCodec::H265 : StreamCodec::H264;
+    int streams = argc > 3 ? std::max(1, std::atoi(argv[3])) : 1;
+    options.decoder_threads = argc > 4 ? std::atoi(argv[4]) : 0;
+    double max_seconds = argc > 5 ? std::atof(argv[5]) : 30.0;
+    options.width = argc > 6 ? std::atoi(argv[6]) : 640;
+    options.height = argc > 7 ? std::atoi(argv[7]) : 640;
+    options.fps = argc > 8 ? std::atoi(argv[8]) : 30;
+
+    std::cout << "=== Decode Benchmark: " << options.source_url << " (" << options.width << "x" << options.height
+              << "@" << options.fps << ", " << streams << " stream(s), decoder threads " << options.decoder_threads
+              << ") ===" << std::endl;
+
+    std::vector<DecodeBackend> backends;
+    if (GstPipelineBuilder::isElementAvailable("nvv4l2decoder") && GstPipelineBuilder::isElementAvailable("nvvideoconvert")) {
+        backends.push_back(DecodeBackend::Nvidia);
+    }
+    if (GstPipelineBuilder::isElementAvailable(GstPipelineBuilder::getSoftwareDecoder(options.codec).c_str())) {
+        backends.push_back(DecodeBackend::Software);
+    }
+    if (backends.empty()) {
+        std::cerr << "No decode backend available" << std::endl;
+        return 1;
+    }
+
+    for (DecodeBackend backend : backends) {
+        for (bool native_yuv : {false, true}) {
+            options.native_yuv_output = native_yuv;
+            std::cout << (native_yuv ? "[native YUV output]" : "[BGR output]") << std::endl;
+            benchmarkBackend(backend, options, streams, max_seconds);
+        }
+    }
+
+    return 0;
+}
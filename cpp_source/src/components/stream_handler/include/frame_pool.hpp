@@ -0,0 +1,52 @@
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+namespace nl_video_analysis {
+
+struct FramePoolStats {
+    size_t fresh_allocations = 0;  // slabs that had to come from the heap
+    size_t reused = 0;             // allocations served from the free list
+    size_t released = 0;           // slabs returned to the heap because the free list was full
+    size_t outstanding = 0;        // slabs currently owned by live frames
+    size_t free_slabs = 0;
+    size_t free_bytes = 0;
+};
+
+// Recycling cv::MatAllocator for clip frames. Slabs are keyed by their byte size (i.e. resolution and
+// type), handed back to a free list when the last Mat referencing them dies, and reused by the next
+// frame of the same shape, so steady-state capture does not touch the heap. Idle slabs are capped in
+// bytes across all sizes (the default keeps about 100 640x640 BGR frames or 21 at 1080p); anything
+// beyond that is freed, so a burst or a high resolution camera does not pin memory forever.
+//
+// Frames can outlive the stream handler that produced them (they sit in clip queues), so pools are
+// owned by a process-wide registry and never destroyed.
+class FramePool : public cv::MatAllocator {
+public:
+    static constexpr size_t kDefaultMaxFreeBytes = size_t(128) << 20;
+
+    // The limit only applies when the camera's pool is created
+    static FramePool* forCamera(const std::string& camera_id, size_t max_free_bytes = kDefaultMaxFreeBytes);
+
+    FramePoolStats getStats() const;
+
+    cv::UMatData* allocate(int dims, const int* sizes, int type, void* data, size_t* step,
+                           cv::AccessFlag flags, cv::UMatUsageFlags usage_flags) const override;
+    bool allocate(cv::UMatData* data, cv::AccessFlag access_flags, cv::UMatUsageFlags usage_flags) const override;
+    void deallocate(cv::UMatData* data) const override;
+
+private:
+    explicit FramePool(size_t max_free_bytes) : max_free_bytes_(max_free_bytes) {}
+
+    size_t max_free_bytes_;
+    mutable std::mutex mutex_;
+    mutable std::unordered_map<size_t, std::vector<uchar*>> free_slabs_;  // keyed by slab size in bytes
+    mutable size_t free_bytes_ = 0;
+    mutable FramePoolStats stats_;
+};
+
+}
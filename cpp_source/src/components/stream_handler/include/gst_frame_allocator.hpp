@@ -0,0 +1,40 @@
+#pragma once
+
+#include <gst/gst.h>
+#include <gst/video/video.h>
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <memory>
+
+namespace nl_video_analysis {
+
+// cv::MatAllocator that lets a cv::Mat borrow the memory of a mapped GstBuffer instead of copying it.
+// The wrapped Mat keeps a reference on the GstSample; the buffer is unmapped and the sample released
+// when the last Mat header sharing it goes away, so frames travel from appsink to the models without
+// a memcpy. Wrapped frames are read-only (the buffer is mapped with GST_MAP_READ): code that needs to
+// modify a frame must write into its own output Mat.
+class GstSampleAllocator : public cv::MatAllocator {
+public:
+    static GstSampleAllocator* getInstance();
+
+    // Wraps one plane of an 8-bit sample (BGR/RGB/GRAY) that starts `offset` bytes into the buffer.
+    // Returns an empty Mat if the buffer cannot be mapped or is smaller than offset + rows * step.
+    // `held`, when given, counts the buffer for as long as the frame lives.
+    cv::Mat wrap(GstSample* sample, int width, int height, int type, size_t step, size_t offset = 0,
+                 std::shared_ptr<std::atomic<int>> held = nullptr) const;
+
+    // Layout of a raw video sample: the GstVideoInfo of its caps, with plane strides and offsets taken
+    // from the buffer's GstVideoMeta when upstream attached one (decoders and converters often pad rows
+    // and planes). Returns false for samples without raw video caps.
+    static bool videoInfo(GstSample* sample, GstVideoInfo& info);
+
+    cv::UMatData* allocate(int dims, const int* sizes, int type, void* data, size_t* step,
+                           cv::AccessFlag flags, cv::UMatUsageFlags usage_flags) const override;
+    bool allocate(cv::UMatData* data, cv::AccessFlag access_flags, cv::UMatUsageFlags usage_flags) const override;
+    void deallocate(cv::UMatData* data) const override;
+
+private:
+    GstSampleAllocator() = default;
+};
+
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "../../../common/include/interfaces.hpp"
+#include <gst/gst.h>
+#include <string>
+
+namespace nl_video_analysis {
+
+enum class DecodeBackend {
+    Auto,      // NVIDIA when its elements are installed, software otherwise
+    Nvidia,    // nvv4l2decoder + nvvideoconvert (Jetson / dGPU with DeepStream plugins)
+    Software   // avdec_h26x + videoscale + videoconvert, runs anywhere
+};
+
+struct DecodePipelineOptions {
+    std::string source_url;               // rtsp://... or a local MP4 file
+    StreamCodec codec = StreamCodec::H264;
+    DecodeBackend backend = DecodeBackend::Auto;
+    int width = 640;
+    int height = 640;
+    int fps = 30;
+    int decoder_threads = 0;              // software backend only; 0 lets the elements pick (all cores)
+    DecodeMode decode_mode = DecodeMode::All;  // reduced modes drop videorate and deliver frames as decoded
+    bool native_yuv_output = false;       // deliver the backend's YUV format (NV12 / I420) instead of BGR
+    uint64_t segment_duration_ns = 0;     // > 0 tees the parsed stream into a splitmuxsink named "recorder"
+};
+
+// Builds gst_parse_launch descriptions for the decode pipelines. The appsink is always named "sink".
+class GstPipelineBuilder {
+public:
+    static std::string build(const DecodePipelineOptions& options);
+
+    // Post-launch setup that cannot be expressed in the description (keyframe filtering for the software
+    // decoder, which has no keyframe-only mode). The decoder element is named "decoder".
+    static bool configurePipeline(GstElement* pipeline, const DecodePipelineOptions& options);
+
+    // Resolves Auto by probing the element registry; an explicit backend is returned as is
+    static DecodeBackend resolveBackend(DecodeBackend requested);
+    static bool isElementAvailable(const char* factory_name);
+
+    static DecodeBackend parseBackend(const std::string& name);
+    static std::string backendName(DecodeBackend backend);
+    static std::string decodeModeName(DecodeMode mode);
+
+    static std::string getDepayElement(StreamCodec codec);
+    static std::string getParserElement(StreamCodec codec);
+    static std::string getSoftwareDecoder(StreamCodec codec);
+
+private:
+    static std::string buildSource(const DecodePipelineOptions& options);
+    static std::string buildDecoder(const DecodePipelineOptions& options, DecodeBackend backend);
+};
+
+}
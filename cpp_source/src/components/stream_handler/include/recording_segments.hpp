@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace nl_video_analysis {
+
+// Segments written by the RTSP recorder, in the order splitmuxsink opened them, and the clips that span
+// them. Times are stream running times in ms, the timeline both segment starts and frame PTS live on.
+class RecordingSegments {
+public:
+    struct ClipRecording {
+        std::vector<std::string> paths;  // every segment the clip spans, first one first
+        uint64_t offset_ms = 0;          // clip start relative to the start of paths.front()
+    };
+
+    void add(const std::string& path, uint64_t start_ms);
+
+    // The clip starts in the last segment opened at or before `start_ms` and spans every segment opened
+    // up to `end_ms`. Clips must be located in start order: segments before the clip's first one are
+    // dropped, as no later clip can start in them. Empty when nothing has been recorded yet.
+    std::optional<ClipRecording> locate(uint64_t start_ms, uint64_t end_ms);
+
+    size_t size() const { return segments_.size(); }
+    void clear() { segments_.clear(); }
+
+    // Newline-separated paths, as stored in the clip's `segments` metadata. Unlike commas, newlines do not
+    // turn up in storage or source paths.
+    static std::string join(const std::vector<std::string>& paths);
+
+private:
+    struct Segment {
+        std::string path;
+        uint64_t start_ms;
+    };
+
+    std::vector<Segment> segments_;
+};
+
+}
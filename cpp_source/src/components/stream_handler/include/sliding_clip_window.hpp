@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <optional>
+#include <set>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+namespace nl_video_analysis {
+
+// Cuts a stream of frames into fixed-length clips that start every `stride` and may therefore overlap.
+// Frames are buffered once, in arrival order, and each clip receives Mat headers into that buffer, so a
+// frame shared by two overlapping clips costs no extra memory. Clip frames are shared and must be treated
+// as read-only by consumers.
+//
+// Positions are frame indices for count-based clips and timestamps in ms for time-based clips. A
+// count-based clip closes on its last frame; a time-based clip closes on the first frame past its end,
+// since the frame rate is not known in advance. A stride equal to the length gives disjoint clips.
+class SlidingClipWindow {
+public:
+    struct Clip {
+        std::vector<cv::Mat> frames;
+        uint64_t start_timestamp_ms = 0;
+        uint64_t end_timestamp_ms = 0;
+    };
+
+    SlidingClipWindow(int64_t length = 1, int64_t stride = 1, bool count_based = true);
+
+    // Clears the buffer; a stride <= 0 means `length`
+    void reset(int64_t length, int64_t stride, bool count_based);
+
+    // Offsets into each clip of the frames it keeps (decode-time sampling). Only frames some clip's plan
+    // asks for are loaded; an empty plan keeps every frame.
+    void setSamplePlan(std::vector<int> offsets);
+
+    // Adds the frame at `position` and returns the clips it completed. `load` is only called when the frame
+    // falls inside a clip and is wanted by the sample plan; it may return an empty Mat if loading failed.
+    std::vector<Clip> push(int64_t position, uint64_t timestamp_ms, const std::function<cv::Mat()>& load);
+
+    void clear();
+
+    size_t bufferedFrames() const;
+    int64_t getLength() const { return length_; }
+    int64_t getStride() const { return stride_; }
+
+private:
+    struct Entry {
+        int64_t position;
+        uint64_t timestamp_ms;
+        cv::Mat frame;  // empty when the frame was not loaded
+    };
+
+    Clip collect() const;
+    void slide();
+    void startAt(int64_t position);
+    bool planWants(int64_t position);
+
+    int64_t length_;
+    int64_t stride_;
+    bool count_based_;
+    std::vector<int> plan_;
+
+    std::deque<Entry> entries_;
+    std::optional<int64_t> window_start_;
+
+    // Positions still wanted by the plans of clips that started at or before the latest position
+    std::set<int64_t> pending_targets_;
+    int64_t next_planned_start_ = 0;
+};
+
+}
@@ -1,11 +1,17 @@
 #pragma once
 
 #include "../../../common/include/interfaces.hpp"
+#include "../../../common/include/blocking_queue.hpp"
+#include "gst_frame_allocator.hpp"
+#include "frame_pool.hpp"
+#include "gst_pipeline_builder.hpp"
+#include "sliding_clip_window.hpp"
+#include "recording_segments.hpp"
 #include <thread>
-#include <queue>
+#include <atomic>
 #include <mutex>
 #include <condition_variable>
-#include <atomic>
+#include <map>
 #include <gst/gst.h>
 #include <gst/app/gstappsink.h>
 #include <opencv2/opencv.hpp>
@@ -19,9 +25,7 @@ private:
     std::string camera_id_;
     std::atomic<bool> is_active_;
     std::thread capture_thread_;
-    std::queue<ClipContainer> clip_queue_;
-    std::mutex queue_mutex_;
-    std::condition_variable queue_cv_;
+    BlockingQueue<ClipContainer> clip_queue_;
 
     int max_queue_size_;
     int frames_per_clip_; 
@@ -30,6 +34,9 @@ private:
     int target_width_;
     int target_height_;
     StreamCodec stream_codec_;
+    DecodeBackend decode_backend_;
+    int decoder_threads_;
+    DecodeMode decode_mode_;
 
     GstElement* pipeline_;
     GstElement* appsink_;
@@ -41,14 +48,12 @@ private:
     void captureLoop();
     bool initializeGStreamer();
     void cleanupGStreamer();
-    std::string buildNvidiaHardwarePipeline() const;
-    std::string getDepayElement() const;
-    std::string getParserElement() const;
+    DecodePipelineOptions buildPipelineOptions() const;
 
-    std::vector<cv::Mat> current_clip_;
-    std::chrono::steady_clock::time_point clip_start_time_;
-    uint64_t clip_start_timestamp_ms_;
-    uint64_t clip_end_timestamp_ms_;
+    // Clips of clip_length starting every clip_stride_ms_ (0: disjoint clips), cut from one shared frame buffer
+    int clip_stride_ms_;
+    SlidingClipWindow clip_window_;
+    int64_t frame_index_;
 
     // For converting relative stream timestamps to absolute UTC
     std::chrono::system_clock::time_point stream_start_system_time_;
@@ -56,6 +61,36 @@ private:
 
     void processFrame(const cv::Mat& frame, uint64_t timestamp_ms);
 
+    // Decode-time sampling: the appsink receives the decoder's YUV (NV12 or I420) and only the planned
+    // frames are converted to BGR
+    int decode_sample_count_;
+    FramePool* frame_pool_;
+
+    void processPlannedFrame(GstSample* sample, const GstVideoInfo& info, uint64_t timestamp_ms);
+    bool isTimeBasedClip() const { return decode_mode_ != DecodeMode::All; }
+    void resetClipWindow();
+    void emitClip(SlidingClipWindow::Clip&& window, bool sampled);
+
+    // BGR frames borrow the appsink's buffers. Fixed-size upstream pools (nvvideoconvert, NVMM and other
+    // hardware pools) stall the decoder once clips hold all of their buffers, so past the pool's limit
+    // frames are copied into the frame pool instead. Pools that grow on demand are never limited.
+    std::shared_ptr<std::atomic<int>> held_buffers_;
+    GstBufferPool* hold_pool_;  // pool hold_limit_ was read from (ref held)
+    int hold_limit_;            // buffers of hold_pool_ that frames may keep; -1: unlimited
+
+    bool canHoldBuffer(GstBuffer* buffer);
+
+    // Segment recording: the parsed elementary stream is teed into a splitmuxsink that writes GOP-aligned
+    // MP4 segments. Segment open messages arrive on the bus thread, clips are emitted on the streaming thread.
+    std::string recording_dir_;
+    std::mutex segment_mutex_;
+    RecordingSegments recorded_segments_;
+
+    void attachRecording(ClipContainer& clip);
+    void handleElementMessage(GstMessage* message);
+    void finalizeRecording();
+    static gchar* onFormatLocation(GstElement* splitmux, guint fragment_id, gpointer user_data);
+
     static GstFlowReturn onNewSample(GstElement* appsink, gpointer user_data);
     static gboolean onBusMessage(GstBus* bus, GstMessage* message, gpointer user_data);
     void handlePipelineError(GstMessage* message);
@@ -65,20 +100,30 @@ private:
 public:
     GStreamerRTSPHandler(int clip_length = 5, int max_queue_size = 10,
                          int target_fps = 30, int target_width = 640, int target_height = 640,
-                         StreamCodec codec = StreamCodec::H264);
+                         StreamCodec codec = StreamCodec::H264,
+                         DecodeBackend backend = DecodeBackend::Auto, int decoder_threads = 0);
     ~GStreamerRTSPHandler();
 
     bool startStream(const std::string& rtsp_url) override;
     void stopStream() override;
     std::optional<ClipContainer> getNextClip() override;
     bool isActive() const override;
+    bool setDecodeSampling(int num_frames) override;
+    bool setSegmentRecording(const std::string& directory) override;
 
     void setCameraId(const std::string& camera_id) { camera_id_ = camera_id; }
     void setFramesPerClip(int frames) { frames_per_clip_ = frames; }
-    void setMaxQueueSize(int size) { max_queue_size_ = size; }
+    void setMaxQueueSize(int size) { max_queue_size_ = size; clip_queue_.setCapacity(size); }
+    QueueStats getQueueStats() const { return clip_queue_.getStats(); }
     void setTargetResolution(int width, int height) { target_width_ = width; target_height_ = height; }
     void setTargetFPS(int fps) { target_fps_ = fps; }
     void setStreamCodec(StreamCodec codec) { stream_codec_ = codec; }
+    void setDecodeBackend(DecodeBackend backend) { decode_backend_ = backend; }
+    void setDecoderThreads(int threads) { decoder_threads_ = threads; }
+    // Reduced modes cut clips by clip_length instead of by frame count
+    void setDecodeMode(DecodeMode mode) { decode_mode_ = mode; }
+    // Start a clip every stride_ms; shorter than clip_length makes clips overlap. 0 keeps clips disjoint.
+    void setClipStride(int stride_ms) { clip_stride_ms_ = std::max(0, stride_ms); }
 };
 
 class OpenCVFileHandler : public IStreamHandler {
@@ -92,6 +137,34 @@ private:
     int current_frame_index_;
     double fps_;
     int total_frames_;
+    FramePool* frame_pool_;  // shared per camera, outlives the handler
+    int decode_sample_count_;
+    bool reference_source_;  // clips point at the source file instead of carrying frames to re-encode
+
+    // Parallel decode: each worker opens its own capture, seeks to its clips and decodes them concurrently.
+    // Finished clips wait in ready_clips_ (keyed by clip index) until getNextClip() hands them out.
+    int decode_workers_;
+    bool ordered_output_;
+    std::vector<std::thread> decode_threads_;
+    std::mutex ready_mutex_;
+    std::condition_variable ready_cv_;
+    std::map<int, std::pair<std::optional<ClipContainer>, int>> ready_clips_;  // clip index -> (clip, frames read)
+    int total_clips_;
+    int next_clip_index_;
+    int finished_workers_;
+    int active_workers_;
+
+    std::optional<ClipContainer> decodeClip(cv::VideoCapture& capture, int first_frame, int& frames_read) const;
+    void startParallelDecode();
+    void decodeRangeLoop(int worker, std::vector<int> clip_indices);
+    // Moves a worker's capture from frame `position` to `target` and returns the frame it reached (-1 if the
+    // file could not be reopened). Seeks are checked; once one misses, the worker reads forward instead.
+    int seekToFrame(cv::VideoCapture& capture, int worker, int target, int position, bool& seek_exact);
+    std::optional<ClipContainer> takeParallelClip();
+
+protected:
+    // Opens the file for one parallel decode worker; virtual so tests can make a worker fail
+    virtual bool openWorkerCapture(cv::VideoCapture& capture, int worker);
 
 public:
     OpenCVFileHandler(int clip_length = 5);
@@ -101,6 +174,12 @@ public:
     void stopStream() override;
     std::optional<ClipContainer> getNextClip() override;
     bool isActive() const override;
+    bool setDecodeSampling(int num_frames) override;
+    bool setSegmentRecording(const std::string& directory) override;
+
+    // workers > 1 decodes the file with that many concurrent captures. Ordered output hands clips out in
+    // file order; unordered output hands them out as they finish (timestamps are always exact).
+    bool setParallelDecode(int workers, bool ordered = true);
 
     void setCameraId(const std::string& camera_id) { camera_id_ = camera_id; }
     void setFramesPerClip(int frames) { frames_per_clip_ = frames; }
@@ -108,5 +187,6 @@ public:
     double getFPS() const { return fps_; }
     int getTotalFrames() const { return total_frames_; }
     int getCurrentFrame() const { return current_frame_index_; }
+    FramePoolStats getFramePoolStats() const { return frame_pool_ ? frame_pool_->getStats() : FramePoolStats{}; }
 };
 }
\ No newline at end of file
@@ -0,0 +1,100 @@
+#include "../include/frame_pool.hpp"
+
+namespace nl_video_analysis {
+
+FramePool* FramePool::forCamera(const std::string& camera_id, size_t max_free_bytes) {
+    static std::mutex registry_mutex;
+    static auto* registry = new std::unordered_map<std::string, FramePool*>();
+
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    auto it = registry->find(camera_id);
+    if (it == registry->end()) {
+        it = registry->emplace(camera_id, new FramePool(max_free_bytes)).first;
+    }
+    return it->second;
+}
+
+FramePoolStats FramePool::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    FramePoolStats stats = stats_;
+    stats.free_slabs = 0;
+    for (const auto& entry : free_slabs_) {
+        stats.free_slabs += entry.second.size();
+    }
+    stats.free_bytes = free_bytes_;
+    return stats;
+}
+
+cv::UMatData* FramePool::allocate(int dims, const int* sizes, int type, void* data, size_t* step,
+                                  cv::AccessFlag /*flags*/, cv::UMatUsageFlags /*usage_flags*/) const {
+    // Same size/step computation as OpenCV's default allocator
+    size_t total = CV_ELEM_SIZE(type);
+    for (int i = dims - 1; i >= 0; i--) {
+        if (step) {
+            if (data && step[i] != CV_AUTOSTEP) {
+                total = step[i];
+            } else {
+                step[i] = total;
+            }
+        }
+        total *= sizes[i];
+    }
+
+    uchar* slab = static_cast<uchar*>(data);
+    if (!slab) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto& free_list = free_slabs_[total];
+        if (!free_list.empty()) {
+            slab = free_list.back();
+            free_list.pop_back();
+            free_bytes_ -= total;
+            stats_.reused++;
+        } else {
+            stats_.fresh_allocations++;
+        }
+        stats_.outstanding++;
+    }
+    if (!slab) {
+        slab = static_cast<uchar*>(cv::fastMalloc(total));
+    }
+
+    cv::UMatData* u = new cv::UMatData(this);
+    u->data = u->origdata = slab;
+    u->size = total;
+    if (data) {
+        u->flags |= cv::UMatData::USER_ALLOCATED;
+    }
+    return u;
+}
+
+bool FramePool::allocate(cv::UMatData* u, cv::AccessFlag /*access_flags*/, cv::UMatUsageFlags /*usage_flags*/) const {
+    return u != nullptr;
+}
+
+void FramePool::deallocate(cv::UMatData* u) const {
+    if (!u) {
+        return;
+    }
+
+    if (!(u->flags & cv::UMatData::USER_ALLOCATED) && u->origdata) {
+        bool recycled = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stats_.outstanding--;
+            if (free_bytes_ + u->size <= max_free_bytes_) {
+                free_slabs_[u->size].push_back(u->origdata);
+                free_bytes_ += u->size;
+                recycled = true;
+            } else {
+                stats_.released++;
+            }
+        }
+        if (!recycled) {
+            cv::fastFree(u->origdata);
+        }
+        u->origdata = nullptr;
+    }
+    delete u;
+}
+
+}
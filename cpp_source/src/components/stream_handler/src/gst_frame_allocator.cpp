@@ -0,0 +1,106 @@
+#include "../include/gst_frame_allocator.hpp"
+
+namespace nl_video_analysis {
+
+namespace {
+
+struct MappedSample {
+    GstSample* sample;
+    GstBuffer* buffer;
+    GstMapInfo map;
+    std::shared_ptr<std::atomic<int>> held;
+};
+
+}
+
+GstSampleAllocator* GstSampleAllocator::getInstance() {
+    // Never destroyed: frames may still be alive during static destruction
+    static GstSampleAllocator* instance = new GstSampleAllocator();
+    return instance;
+}
+
+cv::Mat GstSampleAllocator::wrap(GstSample* sample, int width, int height, int type, size_t step, size_t offset,
+                                 std::shared_ptr<std::atomic<int>> held) const {
+    GstBuffer* buffer = gst_sample_get_buffer(sample);
+    if (!buffer) {
+        return cv::Mat();
+    }
+
+    auto* mapped = new MappedSample{gst_sample_ref(sample), buffer, {}, nullptr};
+    if (!gst_buffer_map(buffer, &mapped->map, GST_MAP_READ)) {
+        gst_sample_unref(mapped->sample);
+        delete mapped;
+        return cv::Mat();
+    }
+
+    size_t required = step * static_cast<size_t>(height);
+    if (mapped->map.size < offset + required) {
+        gst_buffer_unmap(buffer, &mapped->map);
+        gst_sample_unref(mapped->sample);
+        delete mapped;
+        return cv::Mat();
+    }
+
+    cv::Mat frame(height, width, type, mapped->map.data + offset, step);
+    if (held) {
+        held->fetch_add(1);
+        mapped->held = std::move(held);
+    }
+
+    // Attach ref-counted ownership to the otherwise non-owning header
+    cv::UMatData* u = new cv::UMatData(this);
+    u->data = u->origdata = mapped->map.data + offset;
+    u->size = required;
+    u->handle = mapped;
+    u->refcount = 1;
+    frame.u = u;
+
+    return frame;
+}
+
+bool GstSampleAllocator::videoInfo(GstSample* sample, GstVideoInfo& info) {
+    GstCaps* caps = gst_sample_get_caps(sample);
+    GstBuffer* buffer = gst_sample_get_buffer(sample);
+    if (!caps || !buffer || !gst_video_info_from_caps(&info, caps)) {
+        return false;
+    }
+
+    GstVideoMeta* meta = gst_buffer_get_video_meta(buffer);
+    if (meta) {
+        for (guint plane = 0; plane < meta->n_planes; ++plane) {
+            info.offset[plane] = meta->offset[plane];
+            info.stride[plane] = meta->stride[plane];
+        }
+    }
+    return true;
+}
+
+cv::UMatData* GstSampleAllocator::allocate(int dims, const int* sizes, int type, void* data, size_t* step,
+                                           cv::AccessFlag flags, cv::UMatUsageFlags usage_flags) const {
+    // Regular allocations (e.g. create() on a wrapped Mat after release) go to the default heap allocator
+    return cv::Mat::getStdAllocator()->allocate(dims, sizes, type, data, step, flags, usage_flags);
+}
+
+bool GstSampleAllocator::allocate(cv::UMatData* data, cv::AccessFlag access_flags,
+                                  cv::UMatUsageFlags usage_flags) const {
+    return cv::Mat::getStdAllocator()->allocate(data, access_flags, usage_flags);
+}
+
+void GstSampleAllocator::deallocate(cv::UMatData* u) const {
+    if (!u) {
+        return;
+    }
+
+    auto* mapped = static_cast<MappedSample*>(u->handle);
+    if (mapped) {
+        gst_buffer_unmap(mapped->buffer, &mapped->map);
+        gst_sample_unref(mapped->sample);
+        if (mapped->held) {
+            mapped->held->fetch_sub(1);
+        }
+        delete mapped;
+    }
+    delete u;
+}
+
+}
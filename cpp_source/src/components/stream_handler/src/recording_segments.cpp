@@ -0,0 +1,43 @@
+#include "../include/recording_segments.hpp"
+
+namespace nl_video_analysis {
+
+void RecordingSegments::add(const std::string& path, uint64_t start_ms) {
+    segments_.push_back({path, start_ms});
+}
+
+std::optional<RecordingSegments::ClipRecording> RecordingSegments::locate(uint64_t start_ms, uint64_t end_ms) {
+    if (segments_.empty()) {
+        return std::nullopt;
+    }
+
+    size_t first = 0;
+    while (first + 1 < segments_.size() && segments_[first + 1].start_ms <= start_ms) {
+        first++;
+    }
+    size_t last = first;
+    while (last + 1 < segments_.size() && segments_[last + 1].start_ms <= end_ms) {
+        last++;
+    }
+
+    ClipRecording recording;
+    for (size_t i = first; i <= last; ++i) {
+        recording.paths.push_back(segments_[i].path);
+    }
+    recording.offset_ms = start_ms > segments_[first].start_ms ? start_ms - segments_[first].start_ms : 0;
+
+    // Overlapping clips may start in an earlier segment than the one the previous clip ended in, so only
+    // the segments before this clip's first one are dropped
+    segments_.erase(segments_.begin(), segments_.begin() + static_cast<std::ptrdiff_t>(first));
+    return recording;
+}
+
+std::string RecordingSegments::join(const std::vector<std::string>& paths) {
+    std::string joined;
+    for (const auto& path : paths) {
+        joined += (joined.empty() ? "" : "\n") + path;
+    }
+    return joined;
+}
+
+}
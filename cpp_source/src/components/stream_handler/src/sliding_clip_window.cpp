@@ -0,0 +1,136 @@
+#include "../include/sliding_clip_window.hpp"
+
+#include <algorithm>
+
+namespace nl_video_analysis {
+
+SlidingClipWindow::SlidingClipWindow(int64_t length, int64_t stride, bool count_based) {
+    reset(length, stride, count_based);
+}
+
+void SlidingClipWindow::reset(int64_t length, int64_t stride, bool count_based) {
+    length_ = std::max<int64_t>(1, length);
+    stride_ = stride > 0 ? stride : length_;
+    count_based_ = count_based;
+    clear();
+}
+
+void SlidingClipWindow::setSamplePlan(std::vector<int> offsets) {
+    plan_ = std::move(offsets);
+    pending_targets_.clear();
+}
+
+void SlidingClipWindow::clear() {
+    entries_.clear();
+    window_start_.reset();
+    pending_targets_.clear();
+}
+
+size_t SlidingClipWindow::bufferedFrames() const {
+    return std::count_if(entries_.begin(), entries_.end(), [](const Entry& entry) { return !entry.frame.empty(); });
+}
+
+std::vector<SlidingClipWindow::Clip> SlidingClipWindow::push(int64_t position, uint64_t timestamp_ms,
+                                                             const std::function<cv::Mat()>& load) {
+    std::vector<Clip> clips;
+
+    // Close every clip that ends at or before this frame. Time-based clips always close here; after a gap in
+    // the stream the remaining buffered frames may complete several overlapping clips in a row.
+    while (window_start_ && position >= *window_start_ + length_) {
+        if (!entries_.empty()) {
+            clips.push_back(collect());
+        }
+        slide();
+        if (entries_.empty() && position >= *window_start_ + length_) {
+            window_start_.reset();
+        }
+    }
+
+    if (!window_start_) {
+        startAt(position);
+    }
+    if (position < *window_start_) {
+        // Between two clips (stride longer than the clip)
+        return clips;
+    }
+
+    entries_.push_back(Entry{position, timestamp_ms, planWants(position) ? load() : cv::Mat()});
+
+    if (count_based_ && position >= *window_start_ + length_ - 1) {
+        clips.push_back(collect());
+        slide();
+    }
+    return clips;
+}
+
+SlidingClipWindow::Clip SlidingClipWindow::collect() const {
+    Clip clip;
+    clip.start_timestamp_ms = entries_.front().timestamp_ms;
+    clip.end_timestamp_ms = entries_.back().timestamp_ms;
+
+    if (plan_.empty()) {
+        clip.frames.reserve(entries_.size());
+        for (const auto& entry : entries_) {
+            if (!entry.frame.empty()) {
+                clip.frames.push_back(entry.frame);
+            }
+        }
+        return clip;
+    }
+
+    // Each planned offset takes the first loaded frame at or after it; with sparse frames one frame may stand
+    // in for several offsets and is only taken once
+    clip.frames.reserve(plan_.size());
+    auto it = entries_.begin();
+    const Entry* last_taken = nullptr;
+    for (int offset : plan_) {
+        int64_t target = *window_start_ + offset;
+        while (it != entries_.end() && (it->position < target || it->frame.empty())) {
+            ++it;
+        }
+        if (it == entries_.end()) {
+            break;
+        }
+        if (&*it != last_taken) {
+            clip.frames.push_back(it->frame);
+            last_taken = &*it;
+        }
+    }
+    return clip;
+}
+
+void SlidingClipWindow::slide() {
+    *window_start_ += stride_;
+    while (!entries_.empty() && entries_.front().position < *window_start_) {
+        entries_.pop_front();
+    }
+}
+
+void SlidingClipWindow::startAt(int64_t position) {
+    entries_.clear();
+    window_start_ = position;
+    pending_targets_.clear();
+    next_planned_start_ = position;
+}
+
+bool SlidingClipWindow::planWants(int64_t position) {
+    if (plan_.empty()) {
+        return true;
+    }
+
+    // Register the plans of clips that have started by now; clip starts are window_start + k * stride
+    while (next_planned_start_ <= position) {
+        for (int offset : plan_) {
+            pending_targets_.insert(next_planned_start_ + offset);
+        }
+        next_planned_start_ += stride_;
+    }
+
+    // The first frame at or after a planned position is the one that clip keeps
+    auto end = pending_targets_.upper_bound(position);
+    bool wanted = end != pending_targets_.begin();
+    pending_targets_.erase(pending_targets_.begin(), end);
+    return wanted;
+}
+
+}
@@ -1,22 +1,91 @@
 #include "../include/vision_stream_handlers.hpp"
 #include "../../../common/include/logger.hpp"
+#include "../../../common/include/utils.hpp"
 #include <iostream>
 #include <chrono>
 #include <sstream>
 #include <algorithm>
+#include <cmath>
+#include <filesystem>
 
 namespace nl_video_analysis {
 
+namespace {
+
+// Upstream pool buffers frames never keep: the appsink queue (max-buffers=2) and the one being filled
+constexpr int kUpstreamPoolReserve = 3;
+
+// Converts an NV12 or I420 sample to BGR. Plane strides and offsets come from `info` (see
+// GstSampleAllocator::videoInfo), so rows and planes padded by the decoder are handled.
+bool convertYuvSample(GstSample* sample, const GstVideoInfo& info, cv::Mat& bgr) {
+    GstBuffer* buffer = gst_sample_get_buffer(sample);
+    GstMapInfo map;
+    if (!buffer || !gst_buffer_map(buffer, &map, GST_MAP_READ)) {
+        return false;
+    }
+
+    const int width = GST_VIDEO_INFO_WIDTH(&info);
+    const int height = GST_VIDEO_INFO_HEIGHT(&info);
+    auto plane = [&](int index, int rows, int cols, int type) {
+        size_t offset = GST_VIDEO_INFO_PLANE_OFFSET(&info, index);
+        size_t stride = static_cast<size_t>(GST_VIDEO_INFO_PLANE_STRIDE(&info, index));
+        if (offset + stride * static_cast<size_t>(rows) > map.size) {
+            return cv::Mat();
+        }
+        return cv::Mat(rows, cols, type, map.data + offset, stride);
+    };
+
+    bool converted = false;
+    const GstVideoFormat format = GST_VIDEO_INFO_FORMAT(&info);
+    if (format == GST_VIDEO_FORMAT_NV12) {
+        cv::Mat y_plane = plane(0, height, width, CV_8UC1);
+        cv::Mat uv_plane = plane(1, height / 2, width / 2, CV_8UC2);
+        if (!y_plane.empty() && !uv_plane.empty()) {
+            cv::cvtColorTwoPlane(y_plane, uv_plane, bgr, cv::COLOR_YUV2BGR_NV12);
+            converted = true;
+        }
+    } else if (format == GST_VIDEO_FORMAT_I420) {
+        cv::Mat y_plane = plane(0, height, width, CV_8UC1);
+        cv::Mat u_plane = plane(1, height / 2, width / 2, CV_8UC1);
+        cv::Mat v_plane = plane(2, height / 2, width / 2, CV_8UC1);
+        if (!y_plane.empty() && !u_plane.empty() && !v_plane.empty()) {
+            size_t y_size = static_cast<size_t>(width) * height;
+            size_t uv_size = static_cast<size_t>(width / 2) * (height / 2);
+            if (y_plane.isContinuous() && u_plane.isContinuous() && v_plane.isContinuous() &&
+                u_plane.data == y_plane.data + y_size && v_plane.data == u_plane.data + uv_size) {
+                // Planes are already packed the way OpenCV expects
+                cv::cvtColor(cv::Mat(height * 3 / 2, width, CV_8UC1, y_plane.data), bgr, cv::COLOR_YUV2BGR_I420);
+            } else {
+                // Padded planes: repack into OpenCV's contiguous I420 layout first
+                cv::Mat packed(height * 3 / 2, width, CV_8UC1);
+                y_plane.copyTo(packed.rowRange(0, height));
+                uchar* dst_u = packed.data + y_size;
+                u_plane.copyTo(cv::Mat(height / 2, width / 2, CV_8UC1, dst_u));
+                v_plane.copyTo(cv::Mat(height / 2, width / 2, CV_8UC1, dst_u + uv_size));
+                cv::cvtColor(packed, bgr, cv::COLOR_YUV2BGR_I420);
+            }
+            converted = true;
+        }
+    } else {
+        LOG_ERROR("Unsupported sampled frame format '{}'", GST_VIDEO_INFO_NAME(&info));
+    }
+
+    gst_buffer_unmap(buffer, &map);
+    return converted;
+}
+
+}
+
 GStreamerRTSPHandler::GStreamerRTSPHandler(int clip_length, int max_queue_size,
                                            int target_fps, int target_width, int target_height,
-                                           StreamCodec codec)
-    : is_active_(false), max_queue_size_(max_queue_size), clip_length_(clip_length),
+                                           StreamCodec codec, DecodeBackend backend, int decoder_threads)
+    : is_active_(false), clip_queue_(max_queue_size), max_queue_size_(max_queue_size), clip_length_(clip_length),
       target_fps_(target_fps), target_width_(target_width), target_height_(target_height),
-      stream_codec_(codec), pipeline_(nullptr), appsink_(nullptr), bus_(nullptr), main_loop_(nullptr),
-      stream_start_pts_ms_(0) {
+      stream_codec_(codec), decode_backend_(backend), decoder_threads_(decoder_threads), decode_mode_(DecodeMode::All), pipeline_(nullptr), appsink_(nullptr), bus_(nullptr), main_loop_(nullptr),
+      clip_stride_ms_(0), frame_index_(0), stream_start_pts_ms_(0), decode_sample_count_(0), frame_pool_(nullptr),
+      held_buffers_(std::make_shared<std::atomic<int>>(0)), hold_pool_(nullptr), hold_limit_(-1) {
 
     gst_init(nullptr, nullptr);
-    clip_start_time_ = std::chrono::steady_clock::now();
     this->frames_per_clip_ = this->target_fps_ * this->clip_length_;
 }
 
@@ -35,12 +104,21 @@ bool GStreamerRTSPHandler::startStream(const std::string& rtsp_url) {
         camera_id_ = "rtsp_camera_" + std::to_string(std::hash<std::string>{}(rtsp_url) % 10000);
     }
 
+    frame_pool_ = FramePool::forCamera(camera_id_);
+    {
+        std::lock_guard<std::mutex> lock(segment_mutex_);
+        recorded_segments_.clear();
+    }
+
     if (!initializeGStreamer()) {
         LOG_ERROR("GStreamer initialization failed");
         return false;
     }
 
+    resetClipWindow();
+
     is_active_ = true;
+    clip_queue_.reopen();
     gst_thread_ = std::thread(&GStreamerRTSPHandler::gstreamerLoop, this);
     capture_thread_ = std::thread(&GStreamerRTSPHandler::captureLoop, this);
 
@@ -64,21 +142,17 @@ void GStreamerRTSPHandler::stopStream() {
         capture_thread_.join();
     }
 
+    finalizeRecording();
     cleanupGStreamer();
 
-    queue_cv_.notify_all();
+    clip_queue_.close();
 }
 
 std::optional<ClipContainer> GStreamerRTSPHandler::getNextClip() {
-    std::unique_lock<std::mutex> lock(queue_mutex_);
-    queue_cv_.wait(lock, [this] { return !clip_queue_.empty() || !is_active_; });
-
-    if (clip_queue_.empty()) {
+    ClipContainer clip;
+    if (clip_queue_.pop(clip) != QueueStatus::Ok) {
         return std::nullopt;
     }
-
-    ClipContainer clip = std::move(clip_queue_.front());
-    clip_queue_.pop();
     return clip;
 }
 
@@ -86,50 +160,54 @@ bool GStreamerRTSPHandler::isActive() const {
     return is_active_;
 }
 
-std::string GStreamerRTSPHandler::buildNvidiaHardwarePipeline() const {
-    std::stringstream pipeline_str;
-
-    // NVIDIA hardware-accelerated pipeline based on the Python implementation for the action recognition pipeline
-    pipeline_str << "rtspsrc location=\"" << rtsp_url_ << "\" latency=50 protocol=tcp ! "
-                 << getDepayElement() << " ! "
-                 << getParserElement() << " ! "
-                 << "nvv4l2decoder enable-max-performance=1 ! "
-                 << "nvvideoconvert ! "
-                 << "videorate ! "
-                 << "video/x-raw,width=" << target_width_ << ",height=" << target_height_
-                 << ",framerate=" << target_fps_ << "/1 ! "
-                 << "videoconvert ! "
-                 << "video/x-raw,format=BGR ! "
-                 << "appsink name=sink emit-signals=true sync=false max-buffers=2 drop=true";
-
-    return pipeline_str.str();
+bool GStreamerRTSPHandler::setDecodeSampling(int num_frames) {
+    if (is_active_) {
+        return false;
+    }
+    decode_sample_count_ = std::max(0, num_frames);
+    return true;
 }
 
-std::string GStreamerRTSPHandler::getDepayElement() const {
-    switch (stream_codec_) {
-        case StreamCodec::H264:
-            return "rtph264depay";
-        case StreamCodec::H265:
-            return "rtph265depay";
-        default:
-            return "rtph264depay";
+bool GStreamerRTSPHandler::setSegmentRecording(const std::string& directory) {
+    if (is_active_) {
+        return false;
     }
+
+    std::error_code ec;
+    std::filesystem::create_directories(directory, ec);
+    if (ec) {
+        LOG_ERROR("Cannot create recording directory {}: {}", directory, ec.message());
+        return false;
+    }
+    recording_dir_ = directory;
+    return true;
 }
 
-std::string GStreamerRTSPHandler::getParserElement() const {
-    switch (stream_codec_) {
-        case StreamCodec::H264:
-            return "h264parse";
-        case StreamCodec::H265:
-            return "h265parse";
-        default:
-            return "h264parse";
+DecodePipelineOptions GStreamerRTSPHandler::buildPipelineOptions() const {
+    DecodePipelineOptions options;
+    options.source_url = rtsp_url_;
+    options.codec = stream_codec_;
+    options.backend = decode_backend_;
+    options.width = target_width_;
+    options.height = target_height_;
+    options.fps = target_fps_;
+    options.decoder_threads = decoder_threads_;
+    options.decode_mode = decode_mode_;
+    // Only the sampled frames are converted to BGR, on the CPU, in onNewSample
+    options.native_yuv_output = decode_sample_count_ > 0;
+    if (!recording_dir_.empty()) {
+        options.segment_duration_ns = static_cast<uint64_t>(clip_length_) * GST_SECOND;
     }
+    return options;
 }
 
 bool GStreamerRTSPHandler::initializeGStreamer() {
     GError* error = nullptr;
-    std::string pipeline_str = buildNvidiaHardwarePipeline();
+    DecodePipelineOptions options = buildPipelineOptions();
+    std::string pipeline_str = GstPipelineBuilder::build(options);
+    LOG_INFO("Using {} decode backend ({} frames) for camera '{}'",
+             GstPipelineBuilder::backendName(GstPipelineBuilder::resolveBackend(decode_backend_)),
+             GstPipelineBuilder::decodeModeName(decode_mode_), camera_id_);
     pipeline_ = gst_parse_launch(pipeline_str.c_str(), &error);
     if (!pipeline_ || error) {
         LOG_ERROR("GStreamer pipeline failed: {}", error ? error->message : "Unknown");
@@ -137,6 +215,10 @@ bool GStreamerRTSPHandler::initializeGStreamer() {
         return false;
     }
 
+    if (!GstPipelineBuilder::configurePipeline(pipeline_, options)) {
+        return false;
+    }
+
     appsink_ = gst_bin_get_by_name(GST_BIN(pipeline_), "sink");
     if (!appsink_) {
         LOG_ERROR("Appsink element not found");
@@ -146,11 +228,20 @@ bool GStreamerRTSPHandler::initializeGStreamer() {
     g_object_set(appsink_, "emit-signals", TRUE, "sync", FALSE, "max-buffers", 2, "drop", TRUE, nullptr);
     g_signal_connect(appsink_, "new-sample", G_CALLBACK(onNewSample), this);
 
+    if (!recording_dir_.empty()) {
+        GstElement* recorder = gst_bin_get_by_name(GST_BIN(pipeline_), "recorder");
+        if (recorder) {
+            g_signal_connect(recorder, "format-location", G_CALLBACK(onFormatLocation), this);
+            gst_object_unref(recorder);
+        }
+    }
+
     bus_ = gst_element_get_bus(pipeline_);
     gst_bus_add_signal_watch(bus_);
     g_signal_connect(bus_, "message::error", G_CALLBACK(onBusMessage), this);
     g_signal_connect(bus_, "message::warning", G_CALLBACK(onBusMessage), this);
     g_signal_connect(bus_, "message::info", G_CALLBACK(onBusMessage), this);
+    g_signal_connect(bus_, "message::element", G_CALLBACK(onBusMessage), this);
 
     main_loop_ = g_main_loop_new(nullptr, FALSE);
     return true;
@@ -178,6 +269,12 @@ void GStreamerRTSPHandler::cleanupGStreamer() {
         g_main_loop_unref(main_loop_);
         main_loop_ = nullptr;
     }
+
+    if (hold_pool_) {
+        gst_object_unref(hold_pool_);
+        hold_pool_ = nullptr;
+        hold_limit_ = -1;
+    }
 }
 
 void GStreamerRTSPHandler::gstreamerLoop() {
@@ -196,33 +293,140 @@ void GStreamerRTSPHandler::captureLoop() {
     }
 }
 
+void GStreamerRTSPHandler::resetClipWindow() {
+    // Full-rate clips are cut by frame count, clips of the reduced decode modes by time (their frame count varies)
+    if (isTimeBasedClip()) {
+        int64_t length_ms = static_cast<int64_t>(clip_length_) * 1000;
+        clip_window_.reset(length_ms, clip_stride_ms_ > 0 ? clip_stride_ms_ : length_ms, false);
+    } else {
+        int64_t stride_frames = clip_stride_ms_ > 0 ?
+            std::max<int64_t>(1, static_cast<int64_t>(clip_stride_ms_) * target_fps_ / 1000) : frames_per_clip_;
+        clip_window_.reset(frames_per_clip_, stride_frames, true);
+    }
+    frame_index_ = 0;
+
+    // Full-rate clips plan by frame index, time-based clips by millisecond offset into the clip
+    clip_window_.setSamplePlan(decode_sample_count_ > 0 ?
+        uniformSampleIndices(static_cast<int>(clip_window_.getLength()), decode_sample_count_) : std::vector<int>());
+
+    if (clip_window_.getStride() < clip_window_.getLength()) {
+        LOG_INFO("Camera '{}' emits overlapping clips ({} ms every {} ms)", camera_id_, clip_length_ * 1000, clip_stride_ms_);
+    }
+}
+
 void GStreamerRTSPHandler::processFrame(const cv::Mat& frame, uint64_t timestamp_ms) {
     if (!is_active_) return;
 
-    // Track first frame timestamp.(This will probrably have to change to adapt to the way we'll retrieve the clips)
-    if (current_clip_.empty()) {
-        clip_start_timestamp_ms_ = timestamp_ms;
+    int64_t position = isTimeBasedClip() ? static_cast<int64_t>(timestamp_ms) : frame_index_++;
+    for (auto& clip : clip_window_.push(position, timestamp_ms, [&frame] { return frame; })) {
+        emitClip(std::move(clip), false);
     }
+}
 
-    current_clip_.push_back(frame);
-    clip_end_timestamp_ms_ = timestamp_ms;
-
-    if (current_clip_.size() >= frames_per_clip_) {
-        ClipContainer clip("clip_" + std::to_string(clip_start_timestamp_ms_),
-                         camera_id_, current_clip_,
-                         clip_start_timestamp_ms_, clip_end_timestamp_ms_);
+void GStreamerRTSPHandler::processPlannedFrame(GstSample* sample, const GstVideoInfo& info, uint64_t timestamp_ms) {
+    if (!is_active_) return;
 
-        std::unique_lock<std::mutex> lock(queue_mutex_);
-        if (clip_queue_.size() < max_queue_size_) {
-            clip_queue_.push(std::move(clip));
-            queue_cv_.notify_one();
+    // Only frames some clip's sample plan asks for are converted; overlapping clips share them
+    int64_t position = isTimeBasedClip() ? static_cast<int64_t>(timestamp_ms) : frame_index_++;
+    auto convert = [&] {
+        cv::Mat bgr;
+        bgr.allocator = frame_pool_;
+        if (!convertYuvSample(sample, info, bgr)) {
+            return cv::Mat();
         }
+        return bgr;
+    };
+    for (auto& clip : clip_window_.push(position, timestamp_ms, convert)) {
+        emitClip(std::move(clip), true);
+    }
+}
+
+void GStreamerRTSPHandler::emitClip(SlidingClipWindow::Clip&& window, bool sampled) {
+    std::vector<cv::Mat> frames;
+    std::vector<cv::Mat> sampled_frames;
+    (sampled ? sampled_frames : frames) = std::move(window.frames);
 
-        current_clip_.clear();
-        clip_start_time_ = std::chrono::steady_clock::now();
+    ClipContainer clip("clip_" + std::to_string(window.start_timestamp_ms),
+                       camera_id_, std::move(frames),
+                       window.start_timestamp_ms, window.end_timestamp_ms);
+    clip.sampled_frames = std::move(sampled_frames);
+    attachRecording(clip);
+
+    // Never block the GStreamer streaming thread; a full queue means the consumer is behind
+    if (clip_queue_.tryPush(std::move(clip)) == QueueStatus::Timeout) {
+        LOG_WARN("Clip queue full for camera '{}', dropping clip", camera_id_);
     }
 }
 
+void GStreamerRTSPHandler::attachRecording(ClipContainer& clip) {
+    if (recording_dir_.empty()) {
+        return;
+    }
+
+    // Clip timestamps are wall clock; segments are located on the PTS timeline they were mapped from
+    uint64_t stream_start_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        stream_start_system_time_.time_since_epoch()).count();
+    auto running_ms = [&](uint64_t timestamp_ms) -> uint64_t {
+        uint64_t shifted = timestamp_ms + stream_start_pts_ms_;
+        return shifted > stream_start_ms ? shifted - stream_start_ms : 0;
+    };
+
+    std::lock_guard<std::mutex> lock(segment_mutex_);
+    auto recording = recorded_segments_.locate(running_ms(clip.start_timestamp_ms), running_ms(clip.end_timestamp_ms));
+    if (!recording) {
+        return;
+    }
+
+    clip.clip_path = recording->paths.front();
+    clip.metadata["segment_offset_ms"] = std::to_string(recording->offset_ms);
+    clip.metadata["segments"] = RecordingSegments::join(recording->paths);
+}
+
+void GStreamerRTSPHandler::finalizeRecording() {
+    if (recording_dir_.empty() || !pipeline_ || !bus_) {
+        return;
+    }
+
+    // Without EOS mp4mux never writes the moov atom and the open segment would be unreadable
+    gst_element_send_event(pipeline_, gst_event_new_eos());
+    GstMessage* message = gst_bus_timed_pop_filtered(bus_, 2 * GST_SECOND,
+        static_cast<GstMessageType>(GST_MESSAGE_EOS | GST_MESSAGE_ERROR));
+    if (!message) {
+        LOG_WARN("Timed out finalizing recording for camera '{}'", camera_id_);
+        return;
+    }
+    gst_message_unref(message);
+}
+
+gchar* GStreamerRTSPHandler::onFormatLocation(GstElement* splitmux, guint fragment_id, gpointer user_data) {
+    GStreamerRTSPHandler* handler = static_cast<GStreamerRTSPHandler*>(user_data);
+
+    // Named by wall clock so restarts never overwrite earlier segments
+    uint64_t now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()
+    ).count();
+    std::filesystem::path path = std::filesystem::path(handler->recording_dir_) /
+        ("segment_" + std::to_string(now_ms) + "_" + std::to_string(fragment_id) + ".mp4");
+    return g_strdup(path.string().c_str());
+}
+
+void GStreamerRTSPHandler::handleElementMessage(GstMessage* message) {
+    const GstStructure* structure = gst_message_get_structure(message);
+    if (!structure || !gst_structure_has_name(structure, "splitmuxsink-fragment-opened")) {
+        return;
+    }
+
+    const gchar* location = gst_structure_get_string(structure, "location");
+    GstClockTime running_time = GST_CLOCK_TIME_NONE;
+    gst_structure_get_clock_time(structure, "running-time", &running_time);
+    if (!location) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(segment_mutex_);
+    recorded_segments_.add(location, GST_CLOCK_TIME_IS_VALID(running_time) ? GST_TIME_AS_MSECONDS(running_time) : 0);
+}
+
 GstFlowReturn GStreamerRTSPHandler::onNewSample(GstElement* appsink, gpointer user_data) {
     GStreamerRTSPHandler* handler = static_cast<GStreamerRTSPHandler*>(user_data);
 
@@ -250,16 +454,38 @@ GstFlowReturn GStreamerRTSPHandler::onNewSample(GstElement* appsink, gpointer us
             absolute_time.time_since_epoch()
         ).count();
 
-        GstMapInfo map;
-        if (gst_buffer_map(buffer, &map, GST_MAP_READ)) {
-            GstStructure* structure = gst_caps_get_structure(caps, 0);
-            int width, height;
-            gst_structure_get_int(structure, "width", &width);
-            gst_structure_get_int(structure, "height", &height);
+        GstVideoInfo info;
+        if (!GstSampleAllocator::videoInfo(sample, info)) {
+            LOG_ERROR("Camera '{}' delivered a sample without raw video caps", handler->camera_id_);
+            gst_sample_unref(sample);
+            return GST_FLOW_OK;
+        }
+        int width = GST_VIDEO_INFO_WIDTH(&info);
+        int height = GST_VIDEO_INFO_HEIGHT(&info);
+
+        if (handler->decode_sample_count_ > 0) {
+            handler->processPlannedFrame(sample, info, absolute_timestamp_ms);
+            gst_sample_unref(sample);
+            return GST_FLOW_OK;
+        }
 
-            cv::Mat frame(height, width, CV_8UC3, map.data);
-            handler->processFrame(frame.clone(), absolute_timestamp_ms);
-            gst_buffer_unmap(buffer, &map);
+        // The frame borrows the buffer and keeps the sample alive for as long as any clip references it,
+        // unless that would take too many buffers from a fixed-size upstream pool
+        size_t step = static_cast<size_t>(GST_VIDEO_INFO_PLANE_STRIDE(&info, 0));
+        size_t offset = GST_VIDEO_INFO_PLANE_OFFSET(&info, 0);
+        cv::Mat frame;
+        if (handler->canHoldBuffer(buffer)) {
+            frame = GstSampleAllocator::getInstance()->wrap(sample, width, height, CV_8UC3, step, offset,
+                                                            handler->held_buffers_);
+        } else {
+            cv::Mat view = GstSampleAllocator::getInstance()->wrap(sample, width, height, CV_8UC3, step, offset);
+            if (!view.empty()) {
+                frame.allocator = handler->frame_pool_;
+                view.copyTo(frame);
+            }
+        }
+        if (!frame.empty()) {
+            handler->processFrame(frame, absolute_timestamp_ms);
         }
     }
 
@@ -267,6 +493,34 @@ GstFlowReturn GStreamerRTSPHandler::onNewSample(GstElement* appsink, gpointer us
     return GST_FLOW_OK;
 }
 
+bool GStreamerRTSPHandler::canHoldBuffer(GstBuffer* buffer) {
+    GstBufferPool* pool = buffer->pool;
+    if (!pool) {
+        // Allocated outside any pool, so holding it takes nothing from upstream
+        return true;
+    }
+
+    if (pool != hold_pool_) {
+        if (hold_pool_) {
+            gst_object_unref(hold_pool_);
+        }
+        hold_pool_ = GST_BUFFER_POOL(gst_object_ref(pool));
+
+        guint size = 0, min_buffers = 0, max_buffers = 0;
+        GstStructure* config = gst_buffer_pool_get_config(pool);
+        gst_buffer_pool_config_get_params(config, nullptr, &size, &min_buffers, &max_buffers);
+        gst_structure_free(config);
+
+        hold_limit_ = max_buffers == 0 ? -1 : std::max(0, static_cast<int>(max_buffers) - kUpstreamPoolReserve);
+        if (hold_limit_ >= 0) {
+            LOG_INFO("Camera '{}' decodes into a fixed pool of {} buffers; clips hold at most {} and copy the rest",
+                     camera_id_, max_buffers, hold_limit_);
+        }
+    }
+
+    return hold_limit_ < 0 || held_buffers_->load() < hold_limit_;
+}
+
 gboolean GStreamerRTSPHandler::onBusMessage(GstBus* bus, GstMessage* message, gpointer user_data) {
     GStreamerRTSPHandler* handler = static_cast<GStreamerRTSPHandler*>(user_data);
 
@@ -280,6 +534,9 @@ gboolean GStreamerRTSPHandler::onBusMessage(GstBus* bus, GstMessage* message, gp
         case GST_MESSAGE_INFO:
             handler->handlePipelineInfo(message);
             break;
+        case GST_MESSAGE_ELEMENT:
+            handler->handleElementMessage(message);
+            break;
         default:
             break;
     }
@@ -298,6 +555,7 @@ void GStreamerRTSPHandler::handlePipelineError(GstMessage* message) {
     if (debug_info) g_free(debug_info);
 
     is_active_ = false;
+    clip_queue_.close();
 }
 
 void GStreamerRTSPHandler::handlePipelineWarning(GstMessage* message) {
@@ -321,7 +579,9 @@ void GStreamerRTSPHandler::handlePipelineInfo(GstMessage* message) {
 }
 
 OpenCVFileHandler::OpenCVFileHandler(int clip_length)
-    : is_active_(false), clip_length_(clip_length), current_frame_index_(0), fps_(0), total_frames_(0) {}
+    : is_active_(false), clip_length_(clip_length), current_frame_index_(0), fps_(0), total_frames_(0),
+      frame_pool_(nullptr), decode_sample_count_(0), reference_source_(false), decode_workers_(1),
+      ordered_output_(true), total_clips_(0), next_clip_index_(0), finished_workers_(0), active_workers_(0) {}
 
 OpenCVFileHandler::~OpenCVFileHandler() {
     stopStream();
@@ -345,59 +605,306 @@ bool OpenCVFileHandler::startStream(const std::string& file_path) {
         return false;
     }
 
+    frame_pool_ = FramePool::forCamera(camera_id_);
+
     fps_ = capture_.get(cv::CAP_PROP_FPS);
     frames_per_clip_ = clip_length_ * fps_;
     total_frames_ = static_cast<int>(capture_.get(cv::CAP_PROP_FRAME_COUNT));
     current_frame_index_ = 0;
     is_active_ = true;
 
+    if (decode_workers_ > 1) {
+        startParallelDecode();
+    }
+
     return true;
 }
 
 void OpenCVFileHandler::stopStream() {
     if (!is_active_) return;
 
-    is_active_ = false;
+    {
+        std::lock_guard<std::mutex> lock(ready_mutex_);
+        is_active_ = false;
+    }
+    ready_cv_.notify_all();
+
+    for (auto& thread : decode_threads_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+    decode_threads_.clear();
+    ready_clips_.clear();
+
     if (capture_.isOpened()) {
         capture_.release();
     }
 }
 
 std::optional<ClipContainer> OpenCVFileHandler::getNextClip() {
-    if (!is_active_ || !capture_.isOpened()) {
+    if (!is_active_) {
+        return std::nullopt;
+    }
+
+    if (decode_workers_ > 1) {
+        return takeParallelClip();
+    }
+
+    if (!capture_.isOpened()) {
         return std::nullopt;
     }
 
-    std::vector<cv::Mat> clip_frames;
     int frames_read = 0;
+    std::optional<ClipContainer> clip = decodeClip(capture_, current_frame_index_, frames_read);
+    current_frame_index_ += frames_read;
 
-    while (frames_read < frames_per_clip_ && current_frame_index_ < total_frames_) {
-        cv::Mat frame;
-        if (capture_.read(frame)) {
-            clip_frames.push_back(frame.clone());
-            current_frame_index_++;
+    if (!clip) {
+        is_active_ = false;
+    }
+    return clip;
+}
+
+std::optional<ClipContainer> OpenCVFileHandler::decodeClip(cv::VideoCapture& capture, int first_frame, int& frames_read) const {
+    std::vector<cv::Mat> clip_frames;
+    std::vector<cv::Mat> sampled_frames;
+    int max_frames = std::min(frames_per_clip_, total_frames_ - first_frame);
+    frames_read = 0;
+
+    if (decode_sample_count_ > 0) {
+        // grab() only demuxes/decodes; the colour conversion and copy in retrieve() are paid for planned frames only.
+        // The plan is made for the nominal clip length, so a short final clip may get fewer samples.
+        std::vector<int> plan = uniformSampleIndices(frames_per_clip_, decode_sample_count_);
+        size_t next_sample = 0;
+        while (frames_read < max_frames && capture.grab()) {
+            if (next_sample < plan.size() && plan[next_sample] == frames_read) {
+                cv::Mat frame;
+                frame.allocator = frame_pool_;
+                if (capture.retrieve(frame)) {
+                    sampled_frames.push_back(std::move(frame));
+                }
+                next_sample++;
+            }
             frames_read++;
-        } else {
-            break;
+        }
+    } else {
+        clip_frames.reserve(std::max(0, max_frames));
+        while (frames_read < max_frames) {
+            // Decode straight into a recycled slab; the Mat owns it, so no clone is needed
+            cv::Mat frame;
+            frame.allocator = frame_pool_;
+            if (capture.read(frame)) {
+                clip_frames.push_back(std::move(frame));
+                frames_read++;
+            } else {
+                break;
+            }
         }
     }
 
-    if (clip_frames.empty()) {
-        is_active_ = false;
+    if (frames_read == 0) {
         return std::nullopt;
     }
 
+    int end_frame = first_frame + frames_read;
     uint64_t start_timestamp_ms = (fps_ > 0) ?
-        static_cast<uint64_t>(((current_frame_index_ - frames_read) / fps_) * 1000.0) : 0;
+        static_cast<uint64_t>((first_frame / fps_) * 1000.0) : 0;
     uint64_t end_timestamp_ms = (fps_ > 0) ?
-        static_cast<uint64_t>((current_frame_index_ / fps_) * 1000.0) : 0;
+        static_cast<uint64_t>((end_frame / fps_) * 1000.0) : 0;
 
-    ClipContainer clip("clip_" + std::to_string(current_frame_index_),
-                      camera_id_, clip_frames, start_timestamp_ms, end_timestamp_ms);
+    ClipContainer clip("clip_" + std::to_string(end_frame),
+                      camera_id_, std::move(clip_frames), start_timestamp_ms, end_timestamp_ms);
+    clip.sampled_frames = std::move(sampled_frames);
+
+    if (reference_source_) {
+        clip.clip_path = file_path_;
+        clip.metadata["segment_offset_ms"] = std::to_string(start_timestamp_ms);
+        clip.metadata["segments"] = file_path_;
+    }
 
     return clip;
 }
 
+void OpenCVFileHandler::startParallelDecode() {
+    total_clips_ = frames_per_clip_ > 0 ? (total_frames_ + frames_per_clip_ - 1) / frames_per_clip_ : 0;
+    next_clip_index_ = 0;
+    finished_workers_ = 0;
+    ready_clips_.clear();
+
+    int workers = std::min(decode_workers_, std::max(1, total_clips_));
+    for (int worker = 0; worker < workers; ++worker) {
+        std::vector<int> clip_indices;
+        if (ordered_output_) {
+            // Interleaved clips keep every worker within a few clips of the consumer, so the reorder window stays small
+            for (int index = worker; index < total_clips_; index += workers) {
+                clip_indices.push_back(index);
+            }
+        } else {
+            // One contiguous time range per worker: a single seek, then purely sequential decoding
+            int first = static_cast<int>(static_cast<int64_t>(total_clips_) * worker / workers);
+            int last = static_cast<int>(static_cast<int64_t>(total_clips_) * (worker + 1) / workers);
+            for (int index = first; index < last; ++index) {
+                clip_indices.push_back(index);
+            }
+        }
+        decode_threads_.emplace_back(&OpenCVFileHandler::decodeRangeLoop, this, worker, std::move(clip_indices));
+    }
+    active_workers_ = workers;
+
+    LOG_INFO("Decoding {} with {} workers ({} clips, {} output)", file_path_, workers, total_clips_,
+             ordered_output_ ? "ordered" : "unordered");
+}
+
+bool OpenCVFileHandler::openWorkerCapture(cv::VideoCapture& capture, int /*worker*/) {
+    return capture.open(file_path_);
+}
+
+void OpenCVFileHandler::decodeRangeLoop(int worker, std::vector<int> clip_indices) {
+    cv::VideoCapture capture;
+    if (!openWorkerCapture(capture, worker)) {
+        LOG_ERROR("Decode worker {} cannot open video file: {}", worker, file_path_);
+
+        // Publish the worker's clips as failed right away. The consumer skips them; holding them back would
+        // leave it (and, in ordered mode, the other workers) waiting for clips that never come.
+        std::lock_guard<std::mutex> lock(ready_mutex_);
+        for (int clip_index : clip_indices) {
+            ready_clips_.emplace(clip_index, std::make_pair(std::nullopt, 0));
+        }
+        finished_workers_++;
+        ready_cv_.notify_all();
+        return;
+    }
+
+    const size_t window = static_cast<size_t>(decode_workers_) * 2;
+    int position = 0;
+    bool seek_exact = true;
+
+    for (int clip_index : clip_indices) {
+        {
+            // Back-pressure: never run more than `window` clips ahead of the consumer
+            std::unique_lock<std::mutex> lock(ready_mutex_);
+            ready_cv_.wait(lock, [&] {
+                if (!is_active_) return true;
+                return ordered_output_ ? clip_index < next_clip_index_ + static_cast<int>(window)
+                                       : ready_clips_.size() < window;
+            });
+            if (!is_active_) {
+                break;
+            }
+        }
+
+        int first_frame = clip_index * frames_per_clip_;
+        if (first_frame != position) {
+            position = seekToFrame(capture, worker, first_frame, position, seek_exact);
+        }
+
+        int frames_read = 0;
+        std::optional<ClipContainer> clip;
+        if (position == first_frame) {
+            clip = decodeClip(capture, first_frame, frames_read);
+            position = first_frame + frames_read;
+        } else {
+            LOG_ERROR("Decode worker {} cannot reach frame {} of {}", worker, first_frame, file_path_);
+        }
+
+        std::lock_guard<std::mutex> lock(ready_mutex_);
+        ready_clips_.emplace(clip_index, std::make_pair(std::move(clip), frames_read));
+        ready_cv_.notify_all();
+    }
+
+    std::lock_guard<std::mutex> lock(ready_mutex_);
+    finished_workers_++;
+    ready_cv_.notify_all();
+}
+
+int OpenCVFileHandler::seekToFrame(cv::VideoCapture& capture, int worker, int target, int position, bool& seek_exact) {
+    if (seek_exact) {
+        // Long-GOP files are seeked through the preceding keyframe; a container without an exact index can still
+        // land on the wrong frame, which the reported position gives away
+        if (capture.set(cv::CAP_PROP_POS_FRAMES, target) &&
+            std::lround(capture.get(cv::CAP_PROP_POS_FRAMES)) == target) {
+            return target;
+        }
+        LOG_WARN("Decode worker {} cannot seek {} exactly, reading forward instead", worker, file_path_);
+        seek_exact = false;
+        position = -1;  // unknown after the failed seek
+    }
+
+    if (position < 0 || position > target) {
+        capture.release();
+        if (!openWorkerCapture(capture, worker)) {
+            return -1;
+        }
+        position = 0;
+    }
+    while (position < target && capture.grab()) {
+        position++;
+    }
+    return position;
+}
+
+std::optional<ClipContainer> OpenCVFileHandler::takeParallelClip() {
+    std::unique_lock<std::mutex> lock(ready_mutex_);
+
+    while (true) {
+        ready_cv_.wait(lock, [&] {
+            if (!is_active_ || finished_workers_ == active_workers_) return true;
+            return ordered_output_ ? ready_clips_.count(next_clip_index_) > 0 : !ready_clips_.empty();
+        });
+
+        auto it = ordered_output_ ? ready_clips_.find(next_clip_index_) : ready_clips_.begin();
+        if (it == ready_clips_.end()) {
+            if (is_active_ && finished_workers_ == active_workers_ && !ready_clips_.empty()) {
+                // A worker stopped before publishing all of its clips; skip the missing ones
+                next_clip_index_ = ready_clips_.begin()->first;
+                continue;
+            }
+            // Stopped, or every worker is done and nothing is left to hand out
+            if (is_active_ && finished_workers_ == active_workers_) {
+                current_frame_index_ = total_frames_;
+            }
+            return std::nullopt;
+        }
+
+        std::optional<ClipContainer> clip = std::move(it->second.first);
+        current_frame_index_ += it->second.second;
+        ready_clips_.erase(it);
+        next_clip_index_++;
+        ready_cv_.notify_all();
+
+        // A clip that failed to decode is skipped rather than ending the stream
+        if (clip) {
+            return clip;
+        }
+    }
+}
+
+bool OpenCVFileHandler::setDecodeSampling(int num_frames) {
+    if (is_active_) {
+        return false;
+    }
+    decode_sample_count_ = std::max(0, num_frames);
+    return true;
+}
+
+bool OpenCVFileHandler::setParallelDecode(int workers, bool ordered) {
+    if (is_active_) {
+        return false;
+    }
+    decode_workers_ = std::max(1, workers);
+    ordered_output_ = ordered;
+    return true;
+}
+
+bool OpenCVFileHandler::setSegmentRecording(const std::string& /*directory*/) {
+    if (is_active_) {
+        return false;
+    }
+    // The source file already is the recording; clips just point into it
+    reference_source_ = true;
+    return true;
+}
+
 bool OpenCVFileHandler::isActive() const {
     return is_active_ && current_frame_index_ < total_frames_;
 }
@@ -1,17 +1,25 @@
 #define CATCH_CONFIG_MAIN
 #include "../../../lib/catch2/catch_amalgamated.hpp"
 #include "vision_stream_handlers.hpp"
+#include "gst_frame_allocator.hpp"
+#include "frame_pool.hpp"
+#include "gst_pipeline_builder.hpp"
+#include "sliding_clip_window.hpp"
+#include "recording_segments.hpp"
 #include "../../../common/include/interfaces.hpp"
 #include <opencv2/opencv.hpp>
+#include <algorithm>
 #include <fstream>
+#include <map>
+#include <set>
 
 using namespace nl_video_analysis;
 
-std::string createTestVideo(const std::string& filename, int num_frames, double fps = 30.0) {
+std::string createTestVideo(const std::string& filename, int num_frames, double fps = 30.0,
+                            int fourcc = cv::VideoWriter::fourcc('M', 'J', 'P', 'G')) {
     std::string filepath = "/tmp/" + filename;
 
-    cv::VideoWriter writer(filepath, cv::VideoWriter::fourcc('M', 'J', 'P', 'G'),
-                          fps, cv::Size(640, 480));
+    cv::VideoWriter writer(filepath, fourcc, fps, cv::Size(640, 480));
 
     if (!writer.isOpened()) {
         throw std::runtime_error("Failed to create test video");
@@ -232,3 +240,571 @@ TEST_CASE("OpenCVFileHandler configuration", "[stream_handler]") {
 
     std::remove(test_video.c_str());
 }
+
+TEST_CASE("GstSampleAllocator wraps samples without copying", "[stream_handler]") {
+    gst_init(nullptr, nullptr);
+
+    const int width = 6, height = 4;
+    const size_t step = GST_ROUND_UP_4(width * 3);
+    GstBuffer* buffer = gst_buffer_new_allocate(nullptr, step * height, nullptr);
+    gst_buffer_memset(buffer, 0, 7, step * height);
+    GstSample* sample = gst_sample_new(buffer, nullptr, nullptr, nullptr);
+    gst_buffer_unref(buffer);
+
+    SECTION("Frame points into the buffer and keeps the sample alive") {
+        cv::Mat frame = GstSampleAllocator::getInstance()->wrap(sample, width, height, CV_8UC3, step);
+        REQUIRE_FALSE(frame.empty());
+        REQUIRE(frame.cols == width);
+        REQUIRE(frame.rows == height);
+        REQUIRE(frame.step[0] == step);
+        REQUIRE(frame.at<cv::Vec3b>(3, 5)[2] == 7);
+        REQUIRE(GST_MINI_OBJECT_REFCOUNT_VALUE(sample) == 2);
+
+        GstMapInfo map;
+        REQUIRE(gst_buffer_map(gst_sample_get_buffer(sample), &map, GST_MAP_READ));
+        REQUIRE(frame.data == map.data);
+        gst_buffer_unmap(gst_sample_get_buffer(sample), &map);
+
+        {
+            std::vector<cv::Mat> clip{frame, frame(cv::Rect(1, 1, 2, 2))};
+            frame.release();
+            REQUIRE(GST_MINI_OBJECT_REFCOUNT_VALUE(sample) == 2);
+        }
+        REQUIRE(GST_MINI_OBJECT_REFCOUNT_VALUE(sample) == 1);
+    }
+
+    SECTION("Rejects buffers smaller than the requested frame") {
+        cv::Mat frame = GstSampleAllocator::getInstance()->wrap(sample, width, height * 2, CV_8UC3, step);
+        REQUIRE(frame.empty());
+        REQUIRE(GST_MINI_OBJECT_REFCOUNT_VALUE(sample) == 1);
+
+        REQUIRE(GstSampleAllocator::getInstance()->wrap(sample, width, height, CV_8UC3, step, 1).empty());
+    }
+
+    SECTION("Frames can start past the beginning and count as held") {
+        auto held = std::make_shared<std::atomic<int>>(0);
+        cv::Mat frame = GstSampleAllocator::getInstance()->wrap(sample, width, height - 1, CV_8UC3, step, step, held);
+        REQUIRE_FALSE(frame.empty());
+        REQUIRE(held->load() == 1);
+
+        GstMapInfo map;
+        REQUIRE(gst_buffer_map(gst_sample_get_buffer(sample), &map, GST_MAP_READ));
+        REQUIRE(frame.data == map.data + step);
+        gst_buffer_unmap(gst_sample_get_buffer(sample), &map);
+
+        cv::Mat copy = frame;
+        frame.release();
+        REQUIRE(held->load() == 1);
+        copy.release();
+        REQUIRE(held->load() == 0);
+    }
+
+    gst_sample_unref(sample);
+}
+
+TEST_CASE("GstSampleAllocator reads the plane layout of samples", "[stream_handler]") {
+    gst_init(nullptr, nullptr);
+
+    const int width = 6, height = 4;
+    GstCaps* caps = gst_caps_new_simple("video/x-raw", "format", G_TYPE_STRING, "BGR",
+                                        "width", G_TYPE_INT, width, "height", G_TYPE_INT, height, nullptr);
+    GstBuffer* buffer = gst_buffer_new_allocate(nullptr, 64 + 32 * height, nullptr);
+
+    SECTION("Caps give the default 4-byte aligned stride") {
+        GstSample* sample = gst_sample_new(buffer, caps, nullptr, nullptr);
+        GstVideoInfo info;
+        REQUIRE(GstSampleAllocator::videoInfo(sample, info));
+        REQUIRE(GST_VIDEO_INFO_WIDTH(&info) == width);
+        REQUIRE(GST_VIDEO_INFO_HEIGHT(&info) == height);
+        REQUIRE(GST_VIDEO_INFO_PLANE_STRIDE(&info, 0) == GST_ROUND_UP_4(width * 3));
+        REQUIRE(GST_VIDEO_INFO_PLANE_OFFSET(&info, 0) == 0);
+        gst_sample_unref(sample);
+    }
+
+    SECTION("Video meta overrides padded strides and offsets") {
+        gsize offsets[GST_VIDEO_MAX_PLANES] = {64};
+        gint strides[GST_VIDEO_MAX_PLANES] = {32};
+        gst_buffer_add_video_meta_full(buffer, GST_VIDEO_FRAME_FLAG_NONE, GST_VIDEO_FORMAT_BGR, width, height, 1,
+                                       offsets, strides);
+        GstSample* sample = gst_sample_new(buffer, caps, nullptr, nullptr);
+        GstVideoInfo info;
+        REQUIRE(GstSampleAllocator::videoInfo(sample, info));
+        REQUIRE(GST_VIDEO_INFO_PLANE_STRIDE(&info, 0) == 32);
+        REQUIRE(GST_VIDEO_INFO_PLANE_OFFSET(&info, 0) == 64);
+        gst_sample_unref(sample);
+    }
+
+    SECTION("Samples without raw video caps are rejected") {
+        GstSample* sample = gst_sample_new(buffer, nullptr, nullptr, nullptr);
+        GstVideoInfo info;
+        REQUIRE_FALSE(GstSampleAllocator::videoInfo(sample, info));
+        gst_sample_unref(sample);
+    }
+
+    gst_buffer_unref(buffer);
+    gst_caps_unref(caps);
+}
+
+TEST_CASE("FramePool recycles frame buffers", "[stream_handler]") {
+    // Room for two idle 32x32 slabs
+    FramePool* pool = FramePool::forCamera("test_frame_pool", 2 * 32 * 32);
+    REQUIRE(pool == FramePool::forCamera("test_frame_pool"));
+
+    SECTION("Released slabs are reused by frames of the same shape") {
+        uchar* first_data = nullptr;
+        {
+            cv::Mat frame;
+            frame.allocator = pool;
+            frame.create(32, 32, CV_8UC1);
+            first_data = frame.data;
+            REQUIRE(pool->getStats().outstanding == 1);
+        }
+        REQUIRE(pool->getStats().outstanding == 0);
+
+        cv::Mat frame;
+        frame.allocator = pool;
+        frame.create(32, 32, CV_8UC1);
+        REQUIRE(frame.data == first_data);
+        REQUIRE(pool->getStats().reused >= 1);
+    }
+
+    SECTION("Idle slabs beyond the limit are returned to the heap") {
+        size_t released_before = pool->getStats().released;
+        {
+            std::vector<cv::Mat> frames(4);
+            for (auto& frame : frames) {
+                frame.allocator = pool;
+                frame.create(32, 32, CV_8UC1);
+            }
+        }
+        REQUIRE(pool->getStats().released - released_before == 2);
+        REQUIRE(pool->getStats().free_bytes <= 2 * 32 * 32);
+    }
+
+    SECTION("Slabs larger than the byte limit are never kept") {
+        size_t released_before = pool->getStats().released;
+        {
+            cv::Mat frame;
+            frame.allocator = pool;
+            frame.create(64, 64, CV_8UC1);
+        }
+        REQUIRE(pool->getStats().released - released_before == 1);
+    }
+}
+
+TEST_CASE("SlidingClipWindow cuts overlapping clips", "[stream_handler]") {
+    auto makeFrame = [] { return cv::Mat(4, 4, CV_8UC1, cv::Scalar(0)); };
+
+    SECTION("A stride equal to the length gives disjoint clips") {
+        SlidingClipWindow window(3, 3, true);
+        std::vector<SlidingClipWindow::Clip> clips;
+        for (int i = 0; i < 9; ++i) {
+            for (auto& clip : window.push(i, i * 100, makeFrame)) {
+                clips.push_back(std::move(clip));
+            }
+        }
+        REQUIRE(clips.size() == 3);
+        REQUIRE(clips[1].frames.size() == 3);
+        REQUIRE(clips[1].start_timestamp_ms == 300);
+        REQUIRE(clips[1].end_timestamp_ms == 500);
+        REQUIRE(window.bufferedFrames() == 0);
+    }
+
+    SECTION("Overlapping clips share frame buffers") {
+        SlidingClipWindow window(4, 2, true);
+        std::vector<SlidingClipWindow::Clip> clips;
+        for (int i = 0; i < 8; ++i) {
+            for (auto& clip : window.push(i, i * 100, makeFrame)) {
+                clips.push_back(std::move(clip));
+            }
+        }
+        // Clips start at frames 0, 2 and 4
+        REQUIRE(clips.size() == 3);
+        REQUIRE(clips[1].start_timestamp_ms == 200);
+        REQUIRE(clips[0].frames[2].data == clips[1].frames[0].data);
+        REQUIRE(clips[1].frames[2].data == clips[2].frames[0].data);
+        REQUIRE(window.bufferedFrames() == 2);
+    }
+
+    SECTION("A stride longer than the length skips frames between clips") {
+        SlidingClipWindow window(2, 5, true);
+        int loads = 0;
+        size_t clip_count = 0;
+        for (int i = 0; i < 10; ++i) {
+            clip_count += window.push(i, i * 100, [&] { loads++; return makeFrame(); }).size();
+        }
+        REQUIRE(clip_count == 2);
+        REQUIRE(loads == 4);
+    }
+
+    SECTION("Time-based clips close on the first frame past their end") {
+        SlidingClipWindow window(1000, 500, false);
+        std::vector<SlidingClipWindow::Clip> clips;
+        for (uint64_t ts : {0, 300, 600, 900, 1200, 1500}) {
+            for (auto& clip : window.push(static_cast<int64_t>(ts), ts, makeFrame)) {
+                clips.push_back(std::move(clip));
+            }
+        }
+        REQUIRE(clips.size() == 2);
+        REQUIRE(clips[0].frames.size() == 4);
+        REQUIRE(clips[0].end_timestamp_ms == 900);
+        REQUIRE(clips[1].start_timestamp_ms == 600);
+        REQUIRE(clips[1].end_timestamp_ms == 1200);
+    }
+
+    SECTION("Only frames a sample plan asks for are loaded") {
+        SlidingClipWindow window(10, 5, true);
+        window.setSamplePlan(uniformSampleIndices(10, 3));  // offsets 0, 4 and 9
+        std::set<int64_t> loaded;
+        std::vector<SlidingClipWindow::Clip> clips;
+        for (int i = 0; i < 20; ++i) {
+            for (auto& clip : window.push(i, i * 100, [&] { loaded.insert(i); return makeFrame(); })) {
+                clips.push_back(std::move(clip));
+            }
+        }
+        REQUIRE(loaded == std::set<int64_t>{0, 4, 5, 9, 10, 14, 15, 19});
+        REQUIRE(clips.size() == 3);
+        for (const auto& clip : clips) {
+            REQUIRE(clip.frames.size() == 3);
+        }
+    }
+}
+
+TEST_CASE("OpenCVFileHandler decodes into pooled frames", "[stream_handler]") {
+    std::string test_video = createTestVideo("test_pool.avi", 60, 30.0);
+
+    OpenCVFileHandler handler(1);
+    handler.setCameraId("pooled_file_camera");
+    REQUIRE(handler.startStream(test_video));
+
+    {
+        auto clip = handler.getNextClip();
+        REQUIRE(clip.has_value());
+        REQUIRE(handler.getFramePoolStats().outstanding == clip->frames.size());
+    }
+    REQUIRE(handler.getFramePoolStats().outstanding == 0);
+
+    size_t fresh_before = handler.getFramePoolStats().fresh_allocations;
+    auto clip = handler.getNextClip();
+    REQUIRE(clip.has_value());
+    REQUIRE(handler.getFramePoolStats().fresh_allocations == fresh_before);
+
+    handler.stopStream();
+    std::remove(test_video.c_str());
+}
+
+TEST_CASE("OpenCVFileHandler decode-time sampling", "[stream_handler]") {
+    std::string test_video = createTestVideo("test_decode_sampling.avi", 90, 30.0);
+
+    SECTION("Only the planned frames are materialized") {
+        OpenCVFileHandler handler(1);
+        REQUIRE(handler.setDecodeSampling(5));
+        REQUIRE(handler.startStream(test_video));
+
+        auto clip = handler.getNextClip();
+        REQUIRE(clip.has_value());
+        REQUIRE(clip->frames.empty());
+        REQUIRE(clip->sampled_frames.size() == 5);
+        REQUIRE(clip->sampled_frames[0].size() == cv::Size(640, 480));
+        REQUIRE(handler.getCurrentFrame() == 30);
+        handler.stopStream();
+    }
+
+    SECTION("Sampling plan cannot change while streaming") {
+        OpenCVFileHandler handler(1);
+        REQUIRE(handler.startStream(test_video));
+        REQUIRE_FALSE(handler.setDecodeSampling(5));
+        handler.stopStream();
+    }
+
+    std::remove(test_video.c_str());
+}
+
+TEST_CASE("OpenCVFileHandler references the source as the clip recording", "[stream_handler]") {
+    std::string test_video = createTestVideo("test_reference.avi", 60, 30.0);
+
+    OpenCVFileHandler handler(1);
+    REQUIRE(handler.setSegmentRecording("/tmp/unused_recordings"));
+    REQUIRE(handler.startStream(test_video));
+
+    auto first = handler.getNextClip();
+    auto second = handler.getNextClip();
+    REQUIRE(first.has_value());
+    REQUIRE(second.has_value());
+    REQUIRE(first->clip_path == test_video);
+    REQUIRE(first->metadata.at("segment_offset_ms") == "0");
+    REQUIRE(second->metadata.at("segment_offset_ms") == "1000");
+
+    handler.stopStream();
+    std::remove(test_video.c_str());
+}
+
+TEST_CASE("RecordingSegments maps RTSP clips to recorded segments", "[stream_handler]") {
+    // 5 s segments opened at running times 100, 5100 and 10100 ms
+    RecordingSegments segments;
+    segments.add("/rec/segment_0.mp4", 100);
+    segments.add("/rec/segment_1.mp4", 5100);
+    segments.add("/rec/segment_2.mp4", 10100);
+
+    SECTION("Nothing recorded yet") {
+        RecordingSegments empty;
+        REQUIRE_FALSE(empty.locate(0, 5000).has_value());
+    }
+
+    SECTION("A clip inside one segment") {
+        auto recording = segments.locate(1100, 4100);
+        REQUIRE(recording.has_value());
+        REQUIRE(recording->paths == std::vector<std::string>{"/rec/segment_0.mp4"});
+        REQUIRE(recording->offset_ms == 1000);
+    }
+
+    SECTION("A clip crossing a segment boundary lists every segment it spans") {
+        auto recording = segments.locate(4000, 10500);
+        REQUIRE(recording.has_value());
+        REQUIRE(recording->paths ==
+                std::vector<std::string>{"/rec/segment_0.mp4", "/rec/segment_1.mp4", "/rec/segment_2.mp4"});
+        REQUIRE(recording->offset_ms == 3900);
+        REQUIRE(RecordingSegments::join(recording->paths) ==
+                "/rec/segment_0.mp4\n/rec/segment_1.mp4\n/rec/segment_2.mp4");
+    }
+
+    SECTION("Frames before the first segment start at offset 0") {
+        auto recording = segments.locate(50, 2000);
+        REQUIRE(recording->paths.front() == "/rec/segment_0.mp4");
+        REQUIRE(recording->offset_ms == 0);
+    }
+
+    SECTION("Overlapping clips keep the segments they still start in") {
+        // Clips of 5 s every 2.5 s
+        auto first = segments.locate(2600, 7600);
+        REQUIRE(first->paths == std::vector<std::string>{"/rec/segment_0.mp4", "/rec/segment_1.mp4"});
+        auto second = segments.locate(5100, 10100);
+        REQUIRE(second->paths == std::vector<std::string>{"/rec/segment_1.mp4", "/rec/segment_2.mp4"});
+        REQUIRE(second->offset_ms == 0);
+        REQUIRE(segments.size() == 2);
+
+        auto third = segments.locate(7600, 12600);
+        REQUIRE(third->paths.front() == "/rec/segment_1.mp4");
+        REQUIRE(third->offset_ms == 2500);
+    }
+}
+
+TEST_CASE("GstPipelineBuilder backends", "[stream_handler]") {
+    gst_init(nullptr, nullptr);
+
+    DecodePipelineOptions options;
+    options.source_url = "rtsp://camera/stream";
+    options.codec = StreamCodec::H265;
+
+    SECTION("Remux recording tees the parsed stream into a segment muxer") {
+        options.backend = DecodeBackend::Software;
+        options.segment_duration_ns = 5 * GST_SECOND;
+        std::string pipeline = GstPipelineBuilder::build(options);
+
+        REQUIRE(pipeline.find("h265parse ! tee name=rec_tee") != std::string::npos);
+        REQUIRE(pipeline.find("splitmuxsink name=recorder max-size-time=5000000000") != std::string::npos);
+        REQUIRE(pipeline.find("rec_tee. ! queue ! avdec_h265") != std::string::npos);
+    }
+
+    SECTION("Software backend uses libav decoding and threaded conversion") {
+        options.backend = DecodeBackend::Software;
+        options.decoder_threads = 4;
+        std::string pipeline = GstPipelineBuilder::build(options);
+
+        REQUIRE(pipeline.find("rtph265depay ! h265parse") != std::string::npos);
+        REQUIRE(pipeline.find("avdec_h265 max-threads=4") != std::string::npos);
+        REQUIRE(pipeline.find("videoconvert n-threads=4") != std::string::npos);
+        REQUIRE(pipeline.find("format=BGR") != std::string::npos);
+        REQUIRE(pipeline.find("nvv4l2decoder") == std::string::npos);
+    }
+
+    SECTION("NVIDIA backend uses hardware decode") {
+        options.backend = DecodeBackend::Nvidia;
+        options.native_yuv_output = true;
+        std::string pipeline = GstPipelineBuilder::build(options);
+
+        REQUIRE(pipeline.find("nvv4l2decoder") != std::string::npos);
+        REQUIRE(pipeline.find("format=NV12") != std::string::npos);
+        REQUIRE(pipeline.find("videoconvert") == std::string::npos);
+    }
+
+    SECTION("Reduced decode modes skip frames and drop videorate") {
+        options.decode_mode = DecodeMode::Keyframes;
+        options.backend = DecodeBackend::Nvidia;
+        std::string nvidia = GstPipelineBuilder::build(options);
+        REQUIRE(nvidia.find("skip-frames=2") != std::string::npos);
+        REQUIRE(nvidia.find("videorate") == std::string::npos);
+        REQUIRE(nvidia.find("framerate=") == std::string::npos);
+
+        options.decode_mode = DecodeMode::NonReference;
+        options.backend = DecodeBackend::Software;
+        std::string software = GstPipelineBuilder::build(options);
+        REQUIRE(software.find("skip-frame=1") != std::string::npos);
+        REQUIRE(software.find("videorate") == std::string::npos);
+
+        options.decode_mode = DecodeMode::All;
+        REQUIRE(GstPipelineBuilder::build(options).find("videorate") != std::string::npos);
+    }
+
+    SECTION("Auto resolves to a concrete backend") {
+        DecodeBackend backend = GstPipelineBuilder::resolveBackend(DecodeBackend::Auto);
+        REQUIRE(backend != DecodeBackend::Auto);
+        if (!GstPipelineBuilder::isElementAvailable("nvv4l2decoder")) {
+            REQUIRE(backend == DecodeBackend::Software);
+        }
+    }
+
+    SECTION("Backend names round-trip") {
+        REQUIRE(GstPipelineBuilder::parseBackend("software") == DecodeBackend::Software);
+        REQUIRE(GstPipelineBuilder::parseBackend("NVIDIA") == DecodeBackend::Nvidia);
+        REQUIRE(GstPipelineBuilder::parseBackend("unknown") == DecodeBackend::Auto);
+        REQUIRE(GstPipelineBuilder::backendName(DecodeBackend::Software) == "software");
+    }
+}
+
+// A file handler whose decode worker `failing_worker` cannot open the file
+class FailingWorkerFileHandler : public OpenCVFileHandler {
+public:
+    FailingWorkerFileHandler(int clip_length, int failing_worker)
+        : OpenCVFileHandler(clip_length), failing_worker_(failing_worker) {}
+
+protected:
+    bool openWorkerCapture(cv::VideoCapture& capture, int worker) override {
+        return worker != failing_worker_ && OpenCVFileHandler::openWorkerCapture(capture, worker);
+    }
+
+private:
+    int failing_worker_;
+};
+
+// Grayscale copies of a clip's frames: small enough to keep a whole file's worth, and still different for any two
+// frames of the test videos
+static std::vector<cv::Mat> grayFrames(const ClipContainer& clip) {
+    std::vector<cv::Mat> frames;
+    for (const auto& frame : clip.frames) {
+        cv::Mat gray;
+        cv::cvtColor(frame, gray, cv::COLOR_BGR2GRAY);
+        frames.push_back(gray);
+    }
+    return frames;
+}
+
+// Parallel clips must hold exactly the frames a single capture decodes, not just the right timestamps
+static void requireParallelMatchesSequential(const std::string& video, int clips, int frames_per_clip) {
+    std::map<uint64_t, std::vector<cv::Mat>> expected;  // by clip start
+    OpenCVFileHandler sequential(1);
+    REQUIRE(sequential.startStream(video));
+    while (sequential.isActive()) {
+        auto clip = sequential.getNextClip();
+        if (!clip) break;
+        expected[clip->start_timestamp_ms] = grayFrames(clip.value());
+    }
+    sequential.stopStream();
+    REQUIRE(expected.size() == static_cast<size_t>(clips));
+
+    for (bool ordered : {true, false}) {
+        INFO((ordered ? "ordered" : "unordered") << " output");
+        OpenCVFileHandler handler(1);
+        REQUIRE(handler.setParallelDecode(3, ordered));
+        REQUIRE(handler.startStream(video));
+
+        std::vector<uint64_t> starts;
+        while (handler.isActive()) {
+            auto clip = handler.getNextClip();
+            if (!clip) break;
+            starts.push_back(clip->start_timestamp_ms);
+            REQUIRE(clip->frames.size() == static_cast<size_t>(frames_per_clip));
+
+            auto it = expected.find(clip->start_timestamp_ms);
+            REQUIRE(it != expected.end());
+            std::vector<cv::Mat> frames = grayFrames(clip.value());
+            REQUIRE(frames.size() == it->second.size());
+            for (size_t i = 0; i < frames.size(); ++i) {
+                INFO("clip at " << clip->start_timestamp_ms << " ms, frame " << i);
+                REQUIRE(frames[i].size() == it->second[i].size());
+                REQUIRE(cv::norm(frames[i], it->second[i], cv::NORM_INF) == 0.0);
+            }
+        }
+        REQUIRE(handler.getCurrentFrame() == clips * frames_per_clip);
+        handler.stopStream();
+
+        REQUIRE(starts.size() == expected.size());
+        if (ordered) {
+            REQUIRE(std::is_sorted(starts.begin(), starts.end()));
+        }
+        REQUIRE(std::set<uint64_t>(starts.begin(), starts.end()).size() == expected.size());
+    }
+}
+
+TEST_CASE("OpenCVFileHandler parallel decoding", "[stream_handler]") {
+    std::string test_video = createTestVideo("test_parallel.avi", 300, 30.0);
+
+    SECTION("Output matches sequential decoding") {
+        requireParallelMatchesSequential(test_video, 10, 30);
+    }
+
+    SECTION("Output matches sequential decoding of an inter-coded file") {
+        // Workers seek into the middle of a GOP here, unlike in MJPG where every frame is a keyframe
+        std::string h264_video;
+        try {
+            h264_video = createTestVideo("test_parallel_h264.mp4", 300, 30.0, cv::VideoWriter::fourcc('a', 'v', 'c', '1'));
+        } catch (const std::runtime_error&) {
+            SKIP("OpenCV has no H.264 encoder");
+        }
+        requireParallelMatchesSequential(h264_video, 10, 30);
+        std::remove(h264_video.c_str());
+    }
+
+    SECTION("Unordered output delivers every clip once") {
+        OpenCVFileHandler handler(1);
+        REQUIRE(handler.setParallelDecode(4, false));
+        REQUIRE(handler.startStream(test_video));
+
+        std::set<uint64_t> starts;
+        while (handler.isActive()) {
+            auto clip = handler.getNextClip();
+            if (!clip) break;
+            starts.insert(clip->start_timestamp_ms);
+        }
+
+        REQUIRE(starts.size() == 10);
+        REQUIRE(*starts.rbegin() == 9000);
+        handler.stopStream();
+    }
+
+    SECTION("A worker that cannot open the file only loses its own clips") {
+        for (bool ordered : {true, false}) {
+            // Worker 1 owns clips 1, 4 and 7 when ordered, clips 3-5 when unordered
+            FailingWorkerFileHandler handler(1, 1);
+            REQUIRE(handler.setParallelDecode(3, ordered));
+            REQUIRE(handler.startStream(test_video));
+
+            std::set<uint64_t> starts;
+            while (handler.isActive()) {
+                auto clip = handler.getNextClip();
+                if (!clip) break;
+                starts.insert(clip->start_timestamp_ms);
+            }
+
+            REQUIRE(starts.size() == 7);
+            if (ordered) {
+                REQUIRE(starts == std::set<uint64_t>{0, 2000, 3000, 5000, 6000, 8000, 9000});
+            } else {
+                REQUIRE(starts == std::set<uint64_t>{0, 1000, 2000, 6000, 7000, 8000, 9000});
+            }
+            REQUIRE_FALSE(handler.isActive());
+            handler.stopStream();
+        }
+    }
+
+    SECTION("Stopping mid-file joins the workers") {
+        OpenCVFileHandler handler(1);
+        REQUIRE(handler.setParallelDecode(2, true));
+        REQUIRE(handler.startStream(test_video));
+        REQUIRE(handler.getNextClip().has_value());
+        handler.stopStream();
+        REQUIRE_FALSE(handler.isActive());
+    }
+
+    std::remove(test_video.c_str());
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <utility>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#include "sort_tracker.hpp"
+#include "../../../common/include/interfaces.hpp"
+
+namespace nl_video_analysis {
+
+// Tracks one camera across clips that may overlap in time (RTSP clips with clip_stride_ms < clip_length).
+// Feeding the overlap to the SORT tracker a second time would step every track through the same stretch of
+// time twice and break the IDs the first clip handed out. Only frames after the last tracked frame advance
+// the tracker; a frame the previous clip already covered takes its track IDs from the nearest tracked frame,
+// matched to its own detections by IoU. Detections without such a match are left out, as the tracker would
+// not have confirmed them either.
+class ClipTracker {
+public:
+    ClipTracker(int max_age = 1, int min_hits = 3, double iou_threshold = 0.3);
+
+    // One result list per frame, in the SortTracker::track format; `frame_timestamps_ms` must be ascending
+    std::vector<std::vector<nlohmann::json>> track(const std::vector<std::vector<Detection>>& detections,
+                                                   const std::vector<uint64_t>& frame_timestamps_ms);
+
+    // Capture time of each sampled frame of `clip`, assuming frames are evenly spaced over the clip. Uses
+    // sampled_indices when the clip has them, otherwise (sampling at decode time) the sampled frames' order.
+    static std::vector<uint64_t> sampledFrameTimestamps(const ClipContainer& clip);
+
+private:
+    std::vector<nlohmann::json> reuseTracks(const std::vector<Detection>& detections, uint64_t timestamp_ms) const;
+
+    SortTracker tracker_;
+    double iou_threshold_;
+    std::optional<uint64_t> tracked_until_ms_;
+    // Results of the tracked frames the next clip may still overlap, oldest first
+    std::deque<std::pair<uint64_t, std::vector<nlohmann::json>>> history_;
+};
+
+}
@@ -87,7 +87,6 @@ std::tuple<std::vector<std::pair<int,int>>, std::vector<int>, std::vector<int>>
                                       double iou_threshold);
 std::vector<std::pair<int,int>> linear_assignment(const Eigen::MatrixXd& cost_matrix);
 
-#endif // SORT_TRACKER_H
-
 }
 
+#endif // SORT_TRACKER_H
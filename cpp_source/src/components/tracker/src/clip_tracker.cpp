@@ -0,0 +1,100 @@
+#include "../include/clip_tracker.hpp"
+
+namespace nl_video_analysis {
+
+ClipTracker::ClipTracker(int max_age, int min_hits, double iou_threshold)
+    : tracker_(max_age, min_hits, iou_threshold), iou_threshold_(iou_threshold) {}
+
+std::vector<std::vector<nlohmann::json>> ClipTracker::track(const std::vector<std::vector<Detection>>& detections,
+                                                            const std::vector<uint64_t>& frame_timestamps_ms) {
+    std::vector<std::vector<nlohmann::json>> results;
+    results.reserve(detections.size());
+    if (detections.empty()) {
+        return results;
+    }
+
+    // Frames before this clip's first one are of no use to it or to any later clip
+    uint64_t first_ms = frame_timestamps_ms.empty() ? 0 : frame_timestamps_ms.front();
+    while (history_.size() > 1 && history_[1].first <= first_ms) {
+        history_.pop_front();
+    }
+
+    for (size_t i = 0; i < detections.size(); ++i) {
+        if (i >= frame_timestamps_ms.size()) {
+            // Without a timestamp the frame cannot be placed, so it is tracked as a new one
+            results.push_back(tracker_.track(detections[i]));
+            continue;
+        }
+
+        uint64_t timestamp_ms = frame_timestamps_ms[i];
+        if (tracked_until_ms_ && timestamp_ms <= *tracked_until_ms_) {
+            results.push_back(reuseTracks(detections[i], timestamp_ms));
+            continue;
+        }
+
+        results.push_back(tracker_.track(detections[i]));
+        history_.emplace_back(timestamp_ms, results.back());
+        tracked_until_ms_ = timestamp_ms;
+    }
+    return results;
+}
+
+std::vector<nlohmann::json> ClipTracker::reuseTracks(const std::vector<Detection>& detections,
+                                                     uint64_t timestamp_ms) const {
+    if (history_.empty() || detections.empty()) {
+        return {};
+    }
+
+    auto distance = [timestamp_ms](uint64_t other) {
+        return timestamp_ms > other ? timestamp_ms - other : other - timestamp_ms;
+    };
+    auto nearest = history_.begin();
+    for (auto it = history_.begin(); it != history_.end(); ++it) {
+        if (distance(it->first) < distance(nearest->first)) {
+            nearest = it;
+        }
+    }
+
+    const std::vector<nlohmann::json>& tracks = nearest->second;
+    std::vector<Eigen::Vector4d> boxes;
+    boxes.reserve(tracks.size());
+    for (const auto& track : tracks) {
+        const auto& bbox = track["BoundingBox"];
+        boxes.emplace_back(bbox[0].get<double>(), bbox[1].get<double>(), bbox[2].get<double>(), bbox[3].get<double>());
+    }
+
+    auto [matched, unmatched_dets, unmatched_trks] = associate_detections_to_trackers(detections, boxes, iou_threshold_);
+
+    // The track keeps its identity; box and confidence are this frame's own, so crops line up with its pixels
+    std::vector<nlohmann::json> results;
+    results.reserve(matched.size());
+    for (const auto& [d, t] : matched) {
+        nlohmann::json result = tracks[t];
+        const Detection& det = detections[d];
+        result["BoundingBox"] = {(int)det.x1, (int)det.y1, (int)det.x2, (int)det.y2};
+        result["Confidence"] = std::round(det.score * 100.0) / 100.0;
+        results.push_back(std::move(result));
+    }
+    return results;
+}
+
+std::vector<uint64_t> ClipTracker::sampledFrameTimestamps(const ClipContainer& clip) {
+    std::vector<uint64_t> timestamps;
+    size_t sampled = clip.sampled_frames.size();
+    if (sampled == 0) {
+        return timestamps;
+    }
+
+    uint64_t span = clip.end_timestamp_ms > clip.start_timestamp_ms ? clip.end_timestamp_ms - clip.start_timestamp_ms : 0;
+    bool indexed = clip.sampled_indices.size() == sampled && !clip.frames.empty();
+    size_t total = indexed ? clip.frames.size() : sampled;
+
+    timestamps.reserve(sampled);
+    for (size_t i = 0; i < sampled; ++i) {
+        uint64_t position = indexed ? static_cast<uint64_t>(std::max(0, clip.sampled_indices[i])) : i;
+        timestamps.push_back(clip.start_timestamp_ms + span * position / total);
+    }
+    return timestamps;
+}
+
+}
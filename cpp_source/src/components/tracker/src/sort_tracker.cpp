@@ -135,7 +135,7 @@ associate_detections_to_trackers(const std::vector<nl_video_analysis::Detection>
         for (size_t i = 0; i < detections.size(); ++i) {
             unmatched_dets.push_back(i);
         }
-        return {{}, unmatched_dets, {}};
+        return {std::vector<std::pair<int,int>>{}, unmatched_dets, std::vector<int>{}};
     }
 
     Eigen::MatrixXd det_mat(detections.size(), 4);
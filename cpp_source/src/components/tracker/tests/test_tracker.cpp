@@ -1,5 +1,7 @@
-#include "../../../lib/catch2/catch2amalgamated.hpp"
+#define CATCH_CONFIG_MAIN
+#include "../../../lib/catch2/catch_amalgamated.hpp"
 #include "../include/sort_tracker.hpp"
+#include "../include/clip_tracker.hpp"
 #include <Eigen/Dense>
 
 using namespace nl_video_analysis;
@@ -11,7 +13,7 @@ TEST_CASE("Tracklet lifecycle", "[tracker]") {
     GeneralTracklet tracklet(bbox, 0.9, 1);
 
     REQUIRE(tracklet.age == 0);
-    REQUIRE(tracklet.conf == Approx(0.9));
+    REQUIRE(tracklet.conf == Catch::Approx(0.9));
 
     tracklet.predict();
     REQUIRE(tracklet.age == 1);
@@ -48,3 +50,105 @@ TEST_CASE("SortTracker multiple objects", "[tracker]") {
     auto results = tracker.track(dets);
     REQUIRE(results.size() == 2);
 }
+
+// One object moving 5 px right every 100 ms
+static std::vector<std::vector<nl_video_analysis::Detection>> movingObject(const std::vector<uint64_t>& timestamps_ms) {
+    std::vector<std::vector<nl_video_analysis::Detection>> detections;
+    for (uint64_t timestamp_ms : timestamps_ms) {
+        float x = static_cast<float>(timestamp_ms / 100 * 5);
+        detections.push_back({{x, 20, x + 40, 60, 0.9f, 1}});
+    }
+    return detections;
+}
+
+static std::vector<uint64_t> timestampsFrom(uint64_t start_ms, size_t count) {
+    std::vector<uint64_t> timestamps;
+    for (size_t i = 0; i < count; ++i) {
+        timestamps.push_back(start_ms + i * 100);
+    }
+    return timestamps;
+}
+
+TEST_CASE("ClipTracker keeps track IDs across overlapping clips", "[tracker][clip_tracker]") {
+    ClipTracker tracker(3, 1, 0.3);
+
+    // Two 1 s clips started 500 ms apart: frames 500-900 ms belong to both
+    auto first_timestamps = timestampsFrom(0, 10);
+    auto second_timestamps = timestampsFrom(500, 10);
+    auto first = tracker.track(movingObject(first_timestamps), first_timestamps);
+    auto second_detections = movingObject(second_timestamps);
+    auto second = tracker.track(second_detections, second_timestamps);
+
+    REQUIRE(first.size() == 10);
+    REQUIRE(second.size() == 10);
+    REQUIRE(first[0].size() == 1);
+    int64_t id = first[0][0]["TrackerId"].get<int64_t>();
+
+    for (const auto& frame : first) {
+        REQUIRE(frame.size() == 1);
+        REQUIRE(frame[0]["TrackerId"].get<int64_t>() == id);
+    }
+    for (size_t i = 0; i < second.size(); ++i) {
+        REQUIRE(second[i].size() == 1);
+        REQUIRE(second[i][0]["TrackerId"].get<int64_t>() == id);
+    }
+
+    // Reused tracks carry the frame's own box
+    const auto& bbox = second[0][0]["BoundingBox"];
+    REQUIRE(bbox[0].get<int>() == static_cast<int>(second_detections[0][0].x1));
+    REQUIRE(bbox[2].get<int>() == static_cast<int>(second_detections[0][0].x2));
+}
+
+TEST_CASE("ClipTracker only reuses tracks that match a detection", "[tracker][clip_tracker]") {
+    ClipTracker tracker(3, 1, 0.3);
+
+    auto first_timestamps = timestampsFrom(0, 10);
+    tracker.track(movingObject(first_timestamps), first_timestamps);
+
+    // A detection far from every tracked box in the overlap is not given an ID
+    std::vector<std::vector<nl_video_analysis::Detection>> detections = {{{300, 300, 340, 340, 0.9f, 2}}};
+    auto results = tracker.track(detections, {500});
+    REQUIRE(results.size() == 1);
+    REQUIRE(results[0].empty());
+}
+
+TEST_CASE("ClipTracker tracks disjoint clips like a SortTracker", "[tracker][clip_tracker]") {
+    ClipTracker clip_tracker(3, 1, 0.3);
+    SortTracker sort_tracker(3, 1, 0.3);
+
+    auto timestamps = timestampsFrom(0, 20);
+    auto detections = movingObject(timestamps);
+    std::vector<std::vector<nl_video_analysis::Detection>> first(detections.begin(), detections.begin() + 10);
+    std::vector<std::vector<nl_video_analysis::Detection>> second(detections.begin() + 10, detections.end());
+    auto first_results = clip_tracker.track(first, {timestamps.begin(), timestamps.begin() + 10});
+    auto second_results = clip_tracker.track(second, {timestamps.begin() + 10, timestamps.end()});
+
+    std::vector<std::vector<nlohmann::json>> results = first_results;
+    results.insert(results.end(), second_results.begin(), second_results.end());
+    REQUIRE(results.size() == detections.size());
+    for (size_t i = 0; i < detections.size(); ++i) {
+        auto expected = sort_tracker.track(detections[i]);
+        REQUIRE(results[i].size() == expected.size());
+        for (size_t j = 0; j < expected.size(); ++j) {
+            REQUIRE(results[i][j]["BoundingBox"] == expected[j]["BoundingBox"]);
+        }
+    }
+    REQUIRE(results.front()[0]["TrackerId"] == results.back()[0]["TrackerId"]);
+}
+
+TEST_CASE("ClipTracker estimates sampled frame timestamps", "[tracker][clip_tracker]") {
+    cv::Mat frame(8, 8, CV_8UC3, cv::Scalar(0, 0, 0));
+
+    SECTION("From sampled indices") {
+        ClipContainer clip("clip", "camera", std::vector<cv::Mat>(10, frame), 1000, 2000);
+        clip.sampled_indices = {0, 5, 9};
+        clip.sampled_frames = {frame, frame, frame};
+        REQUIRE(ClipTracker::sampledFrameTimestamps(clip) == std::vector<uint64_t>{1000, 1500, 1900});
+    }
+
+    SECTION("Sampled at decode time") {
+        ClipContainer clip("clip", "camera", std::vector<cv::Mat>{}, 1000, 2000);
+        clip.sampled_frames = {frame, frame, frame, frame};
+        REQUIRE(ClipTracker::sampledFrameTimestamps(clip) == std::vector<uint64_t>{1000, 1250, 1500, 1750});
+    }
+}
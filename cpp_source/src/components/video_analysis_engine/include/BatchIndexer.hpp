@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <fstream>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "BatchProgress.hpp"
+#include "VideoAnalysisEngine.hpp"
+
+namespace nl_video_analysis {
+
+struct BatchIndexerOptions {
+    std::string input_dir;
+    std::string checkpoint_path;   // empty: <input_dir>/.nl_index_checkpoint
+    int file_workers = 0;          // files decoded concurrently; 0 uses every hardware thread
+    std::vector<std::string> extensions = {".mp4", ".mkv", ".avi", ".mov"};
+};
+
+struct BatchSummary {
+    size_t files_total = 0;
+    size_t files_skipped = 0;      // already in the checkpoint
+    size_t files_indexed = 0;
+    size_t files_failed = 0;       // could not be opened or a clip failed processing; retried on the next run
+    size_t clips = 0;
+    size_t frames = 0;
+    double elapsed_seconds = 0.0;
+    bool interrupted = false;
+
+    double clipsPerSecond() const { return elapsed_seconds > 0.0 ? clips / elapsed_seconds : 0.0; }
+    double framesPerSecond() const { return elapsed_seconds > 0.0 ? frames / elapsed_seconds : 0.0; }
+};
+
+// Offline indexing of a directory of video files. Files are spread over a pool of OpenCVFileHandler workers that
+// feed one shared engine as fast as the stages accept clips: there is no pacing and no clip is ever dropped, a full
+// detection queue simply blocks the file workers. A file is appended to the checkpoint once every one of its clips
+// has left the pipeline, so a crashed or interrupted run resumes with the first unfinished file (clips stored for a
+// partially indexed file are stored again).
+class BatchIndexer {
+public:
+    BatchIndexer(const VideoAnalysisConfig& config, BatchIndexerOptions options);
+
+    // Blocks until every pending file is indexed or `running` turns false
+    BatchSummary run(const std::atomic<bool>& running);
+
+    // Video files under `dir` (recursively) with one of the extensions, as paths relative to `dir`, sorted
+    static std::vector<std::string> listVideoFiles(const std::string& dir, const std::vector<std::string>& extensions);
+    static std::set<std::string> loadCheckpoint(const std::string& path);
+
+private:
+    void fileWorkerLoop(size_t worker_index, const std::atomic<bool>& running);
+    bool indexFile(size_t worker_index, const std::string& relative_path, const std::atomic<bool>& running);
+    // Called by progress_ with its lock held
+    void onFileDone(const std::string& relative_path, const BatchFileProgress& progress);
+
+    VideoAnalysisConfig config_;
+    BatchIndexerOptions options_;
+    std::unique_ptr<VideoAnalysisEngine> engine_;
+
+    std::vector<std::string> pending_files_;
+    std::atomic<size_t> next_file_{0};
+
+    std::unique_ptr<BatchProgress> progress_;  // keyed by path relative to input_dir
+    std::atomic<size_t> frames_{0};
+    std::ofstream checkpoint_;
+    BatchSummary summary_;
+};
+
+}
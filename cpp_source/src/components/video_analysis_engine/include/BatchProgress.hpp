@@ -0,0 +1,66 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace nl_video_analysis {
+
+struct BatchFileProgress {
+    size_t clips_submitted = 0;
+    size_t clips_completed = 0;
+    size_t clips_failed = 0;
+    bool ingest_finished = false;
+};
+
+// Per-file clip accounting of a batch run. A file is done once its reader has finished and every clip it
+// submitted has left the pipeline; it is indexed when none of them failed. A file whose reader stopped early
+// stays in flight and is never reported, so it is not checkpointed. Thread-safe: file readers and stage
+// workers report concurrently.
+class BatchProgress {
+public:
+    // Called once per done file, with the progress lock held: it must not call back into BatchProgress
+    using FileDoneCallback = std::function<void(const std::string& file, const BatchFileProgress& progress)>;
+
+    explicit BatchProgress(FileDoneCallback on_file_done = nullptr);
+
+    void startFile(const std::string& file);
+    // Counted before the clip is submitted, since it may complete before the submit call returns
+    void clipSubmitted(const std::string& file);
+    // Undoes clipSubmitted() for a clip the pipeline did not accept
+    void clipRejected(const std::string& file);
+    void clipCompleted(const std::string& file, bool processed);
+    // The file's reader submitted its last clip
+    void finishIngest(const std::string& file);
+    // A file that could not be opened
+    void fileFailed();
+
+    // Blocks until no file is in flight or `running` turns false; returns true when none is left
+    bool waitUntilDone(const std::atomic<bool>& running);
+    // Drops the files still in flight (an interrupted run) and returns how many there were
+    size_t abandon();
+
+    size_t inFlight() const;
+    size_t filesIndexed() const { return files_indexed_; }
+    size_t filesFailed() const { return files_failed_; }
+    size_t clipsProcessed() const { return clips_processed_; }
+
+private:
+    // Called with mutex_ held
+    void finishIfDone(const std::string& file);
+
+    FileDoneCallback on_file_done_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable done_cv_;
+    std::unordered_map<std::string, BatchFileProgress> in_flight_;
+
+    std::atomic<size_t> files_indexed_{0};
+    std::atomic<size_t> files_failed_{0};
+    std::atomic<size_t> clips_processed_{0};
+};
+
+}
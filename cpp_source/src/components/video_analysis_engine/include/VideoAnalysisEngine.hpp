@@ -9,24 +9,44 @@
 #include <mutex>
 #include <condition_variable>
 #include <atomic>
+#include <unordered_map>
+#include <map>
+#include <functional>
 
 #include "../../../common/include/interfaces.hpp"
 #include "../../../common/include/config_parser.hpp"
 #include "../../../common/include/base_model.hpp"
+#include "../../../common/include/model_pool.hpp"
 #include "../../../common/include/utils.hpp"
 #include "../../stream_handler/include/vision_stream_handlers.hpp"
 #include "../../object_detection/include/yolox_detector.hpp"
 #include "../../vlm_engine/include/clip_image_encoder.hpp"
-#include "../../tracker/include/sort_tracker.hpp"
+#include "../../tracker/include/clip_tracker.hpp"
 #include "../../storage_handler/include/milvus_storage_handler.hpp"
 #include "../../frame_sampler/include/frame_samplers.hpp"
+#include "../../frame_sampler/include/motion_gate.hpp"
 #include "../../../common/include/logger.hpp"
 #include "../../../common/include/benchmark.hpp"
+#include "../../../common/include/blocking_queue.hpp"
+#include "../../../common/include/pipeline_stage.hpp"
 
 
 namespace nl_video_analysis {
 
+// A clip travelling through the processing stages, accumulating each stage's results
+struct ClipWorkItem {
+    ClipContainer clip;
+    std::vector<std::vector<Detection>> detections;
+    std::vector<std::vector<nlohmann::json>> tracked_objects;
+    std::map<int64_t, std::vector<std::vector<float>>> embeddings;
+    bool idle = false;  // rejected by the motion gate: passes through the stages without detection or embedding
+};
+
 class VideoAnalysisEngine {
+public:
+    // Invoked once per submitted clip when it leaves the pipeline; processed is false when a stage failed on it
+    using ClipCompletionCallback = std::function<void(const ClipContainer& clip, bool processed)>;
+
 private:
     VideoAnalysisConfig config_;
 
@@ -34,36 +54,76 @@ private:
     std::vector<std::string> camera_ids_;
 
     std::unique_ptr<IFrameSampler> frame_sampler_;
-    
-    // clip queue info
-    std::queue<ClipContainer> clip_queue_;
-    mutable std::mutex clip_queue_mutex_;
-    std::condition_variable clip_queue_cv_;
-    
+    std::unique_ptr<MotionGate> motion_gate_;  // only when config.motion_gate is set
+
+    // detection -> tracking -> embedding -> storage, connected by bounded queues and routed
+    // by camera so every stage sees a camera's clips in order
+    std::unique_ptr<PipelineStage<ClipWorkItem>> detection_stage_;
+    std::unique_ptr<PipelineStage<ClipWorkItem>> tracking_stage_;
+    std::unique_ptr<PipelineStage<ClipWorkItem>> embedding_stage_;
+    std::unique_ptr<PipelineStage<ClipWorkItem>> storage_stage_;
+
     std::vector<std::thread> processing_threads_;
+    // One ingest thread per source so a slow camera never stalls the others
+    std::vector<std::thread> ingest_threads_;
     std::atomic<bool> is_running_;
-    
-    void clipProcessingLoop();
+
+    ClipCompletionCallback completion_callback_;
+
+    void startStages();
+    void startIngestThread(size_t handler_index);
+    void ingestLoop(IStreamHandler* handler, const std::string camera_id);
+    QueueStatus enqueueClip(ClipContainer&& clip, std::chrono::milliseconds timeout);
+    void notifyClipCompleted(const ClipContainer& clip, bool processed);
     void benchmarkReportingLoop();
-    void objectProcessingLoop();
 
-    std::unique_ptr<YOLOXDetector> object_detector_;
-    std::unique_ptr<nl_video_analysis::SortTracker> tracker_;
-    std::unique_ptr<nl_video_analysis::CLIPImageEncoder> clip_image_encoder_;
-    std::unique_ptr<IStorageHandler> storage_handler_;
+    void detectObjects(size_t worker_index, ClipWorkItem& item);
+    void trackObjects(size_t worker_index, ClipWorkItem& item);
+    void embedObjects(size_t worker_index, ClipWorkItem& item);
+    void storeClip(size_t worker_index, ClipWorkItem& item);
+
+    // One inference context per stage worker, leased per clip; with share_model_sessions all contexts of a
+    // model run on one session
+    std::unique_ptr<ModelPool<YOLOXDetector>> detector_pool_;
+    std::unique_ptr<ModelPool<CLIPImageEncoder>> encoder_pool_;
+
+    // Per-worker resources, indexed by the owning stage's worker index
+    std::vector<std::unordered_map<std::string, std::unique_ptr<ClipTracker>>> trackers_;  // keyed by camera_id
+    std::mutex trackers_mutex_;  // guards the maps, not the trackers: a tracker is only used by its worker
+    std::vector<std::unique_ptr<IStorageHandler>> storage_handlers_;
 
     // Benchmark tracking
     std::atomic<size_t> clips_processed_{0};
+    std::atomic<size_t> clips_dropped_{0};
+    std::atomic<size_t> clips_idle_{0};
+
+    void logStageStats(const PipelineStage<ClipWorkItem>& stage) const;
 
 public:
     VideoAnalysisEngine(const VideoAnalysisConfig& config = VideoAnalysisConfig{});
     ~VideoAnalysisEngine();
 
-    bool addSource(const std::string& source_url, const std::string& camera_id, const std::string& source_type, const StreamCodec& stream_codec);
+    bool addSource(const std::string& source_url, const std::string& camera_id, const std::string& source_type, const StreamCodec& stream_codec,
+                   DecodeMode decode_mode = DecodeMode::All);
 
     void start();
     void stop();
 
+    // Starts the processing stages without any sources; clips are then fed in with submitClip().
+    // Used by offline batch indexing, which runs its own file readers.
+    void startProcessing();
+
+    // Samples (if needed) and submits a clip to the detection stage, waiting for room instead of dropping.
+    // Returns false once the pipeline has stopped.
+    bool submitClip(ClipContainer&& clip);
+
+    // Must be set before start()/startProcessing()
+    void setClipCompletionCallback(ClipCompletionCallback callback);
+
+    // Drops a camera's tracker, motion gate reference, stage routing and per-camera metrics once it will send no
+    // more clips (e.g. a batch-indexed file). Only call after every clip of the camera has completed.
+    void releaseCamera(const std::string& camera_id);
+
     bool isRunning() const;
 
     size_t getClipQueueSize() const;
@@ -0,0 +1,203 @@
+#include "../include/BatchIndexer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+
+namespace nl_video_analysis {
+
+BatchIndexer::BatchIndexer(const VideoAnalysisConfig& config, BatchIndexerOptions options)
+    : config_(config), options_(std::move(options)) {
+    if (options_.checkpoint_path.empty()) {
+        options_.checkpoint_path = (std::filesystem::path(options_.input_dir) / ".nl_index_checkpoint").string();
+    }
+}
+
+std::vector<std::string> BatchIndexer::listVideoFiles(const std::string& dir, const std::vector<std::string>& extensions) {
+    std::vector<std::string> files;
+    std::error_code ec;
+    for (auto it = std::filesystem::recursive_directory_iterator(dir, ec);
+         !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+        if (!it->is_regular_file()) {
+            continue;
+        }
+        std::string extension = it->path().extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+        if (std::find(extensions.begin(), extensions.end(), extension) != extensions.end()) {
+            files.push_back(std::filesystem::relative(it->path(), dir).generic_string());
+        }
+    }
+    if (ec) {
+        LOG_ERROR("Cannot list {}: {}", dir, ec.message());
+    }
+
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+std::set<std::string> BatchIndexer::loadCheckpoint(const std::string& path) {
+    std::set<std::string> completed;
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!line.empty()) {
+            completed.insert(line);
+        }
+    }
+    return completed;
+}
+
+BatchSummary BatchIndexer::run(const std::atomic<bool>& running) {
+    summary_ = BatchSummary{};
+
+    std::vector<std::string> files = listVideoFiles(options_.input_dir, options_.extensions);
+    std::set<std::string> completed = loadCheckpoint(options_.checkpoint_path);
+    summary_.files_total = files.size();
+
+    pending_files_.clear();
+    for (const auto& file : files) {
+        if (completed.count(file)) {
+            summary_.files_skipped++;
+        } else {
+            pending_files_.push_back(file);
+        }
+    }
+
+    LOG_INFO("Batch indexing {}: {} file(s), {} already indexed (checkpoint: {})", options_.input_dir,
+             summary_.files_total, summary_.files_skipped, options_.checkpoint_path);
+    if (pending_files_.empty()) {
+        return summary_;
+    }
+
+    checkpoint_.open(options_.checkpoint_path, std::ios::app);
+    if (!checkpoint_.is_open()) {
+        LOG_WARN("Cannot open checkpoint {}, progress will not be resumable", options_.checkpoint_path);
+    }
+
+    progress_ = std::make_unique<BatchProgress>(
+        [this](const std::string& file, const BatchFileProgress& progress) { onFileDone(file, progress); });
+    frames_ = 0;
+    engine_ = std::make_unique<VideoAnalysisEngine>(config_);
+    engine_->setClipCompletionCallback([this](const ClipContainer& clip, bool processed) {
+        progress_->clipCompleted(clip.camera_id, processed);
+    });
+    engine_->startProcessing();
+
+    size_t workers = options_.file_workers > 0 ? static_cast<size_t>(options_.file_workers)
+                                               : std::max(1u, std::thread::hardware_concurrency());
+    workers = std::min(workers, pending_files_.size());
+    LOG_INFO("Indexing {} file(s) with {} file worker(s)", pending_files_.size(), workers);
+
+    auto start = std::chrono::steady_clock::now();
+    next_file_ = 0;
+
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < workers; ++i) {
+        threads.emplace_back(&BatchIndexer::fileWorkerLoop, this, i, std::cref(running));
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    // Every file is read; wait for the stages to drain the clips still in flight
+    bool drained = progress_->waitUntilDone(running);
+
+    engine_->stop();
+    engine_.reset();
+    checkpoint_.close();
+
+    summary_.elapsed_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    summary_.interrupted = !drained || next_file_ < pending_files_.size();
+    summary_.files_indexed = progress_->filesIndexed();
+    summary_.files_failed = progress_->filesFailed();
+    summary_.clips = progress_->clipsProcessed();
+    summary_.frames = frames_;
+    progress_->abandon();
+    return summary_;
+}
+
+void BatchIndexer::fileWorkerLoop(size_t worker_index, const std::atomic<bool>& running) {
+    while (running) {
+        size_t index = next_file_++;
+        if (index >= pending_files_.size()) {
+            break;
+        }
+        indexFile(worker_index, pending_files_[index], running);
+    }
+}
+
+bool BatchIndexer::indexFile(size_t worker_index, const std::string& relative_path, const std::atomic<bool>& running) {
+    std::string path = (std::filesystem::path(options_.input_dir) / relative_path).string();
+
+    OpenCVFileHandler handler(config_.clip_length);
+    // Frame pools live for the whole process, so they are keyed by worker rather than by file
+    handler.setCameraId("batch_worker_" + std::to_string(worker_index));
+    handler.setParallelDecode(config_.file_decode_workers, config_.file_decode_ordered);
+    if (config_.sample_at_decode) {
+        handler.setDecodeSampling(config_.sampled_frames_count);
+    }
+    if (config_.remux_recording && config_.storage_handler.clip_storage_type == "disk") {
+        handler.setSegmentRecording(config_.storage_handler.clip_storage_path);
+    }
+
+    if (!handler.startStream(path)) {
+        progress_->fileFailed();
+        return false;
+    }
+
+    progress_->startFile(relative_path);
+
+    bool stopped = false;
+    while (handler.isActive()) {
+        if (!running) {
+            stopped = true;
+            break;
+        }
+
+        std::optional<ClipContainer> clip;
+        {
+            ScopedTimer timer("clip_retrieval", "batch");
+            clip = handler.getNextClip();
+        }
+        if (!clip.has_value()) {
+            continue;
+        }
+
+        // Clips are keyed by file: storage gets one directory per file and every file gets a fresh tracker
+        clip.value().camera_id = relative_path;
+
+        progress_->clipSubmitted(relative_path);
+        if (!engine_->submitClip(std::move(clip.value()))) {
+            progress_->clipRejected(relative_path);
+            stopped = true;
+            break;
+        }
+    }
+
+    frames_ += static_cast<size_t>(std::max(0, handler.getCurrentFrame()));
+    if (stopped) {
+        // Left in flight and out of the checkpoint, so the next run indexes the file again
+        return false;
+    }
+    progress_->finishIngest(relative_path);
+    return true;
+}
+
+void BatchIndexer::onFileDone(const std::string& relative_path, const BatchFileProgress& progress) {
+    if (progress.clips_failed == 0) {
+        if (checkpoint_.is_open()) {
+            checkpoint_ << relative_path << '\n';
+            checkpoint_.flush();
+        }
+        LOG_INFO("Indexed {} ({} clips) [{}/{}]", relative_path, progress.clips_completed,
+                 progress_->filesIndexed() + progress_->filesFailed(), pending_files_.size());
+    } else {
+        LOG_WARN("{} of {} clips of {} failed, the file will be retried on the next run",
+                 progress.clips_failed, progress.clips_completed, relative_path);
+    }
+
+    // No clip of the file is left in the pipeline, so its tracker and motion gate state can go
+    engine_->releaseCamera(relative_path);
+}
+
+}
@@ -0,0 +1,98 @@
+#include "../include/BatchProgress.hpp"
+
+#include <chrono>
+
+namespace nl_video_analysis {
+
+BatchProgress::BatchProgress(FileDoneCallback on_file_done) : on_file_done_(std::move(on_file_done)) {}
+
+void BatchProgress::startFile(const std::string& file) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    in_flight_[file] = BatchFileProgress{};
+}
+
+void BatchProgress::clipSubmitted(const std::string& file) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    in_flight_[file].clips_submitted++;
+}
+
+void BatchProgress::clipRejected(const std::string& file) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = in_flight_.find(file);
+    if (it != in_flight_.end() && it->second.clips_submitted > 0) {
+        it->second.clips_submitted--;
+    }
+}
+
+void BatchProgress::clipCompleted(const std::string& file, bool processed) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = in_flight_.find(file);
+    if (it == in_flight_.end()) {
+        return;
+    }
+
+    it->second.clips_completed++;
+    if (processed) {
+        clips_processed_++;
+    } else {
+        it->second.clips_failed++;
+    }
+    finishIfDone(file);
+}
+
+void BatchProgress::finishIngest(const std::string& file) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = in_flight_.find(file);
+    if (it == in_flight_.end()) {
+        return;
+    }
+    it->second.ingest_finished = true;
+    finishIfDone(file);
+}
+
+void BatchProgress::fileFailed() {
+    files_failed_++;
+}
+
+bool BatchProgress::waitUntilDone(const std::atomic<bool>& running) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (running && !in_flight_.empty()) {
+        done_cv_.wait_for(lock, std::chrono::milliseconds(100));
+    }
+    return in_flight_.empty();
+}
+
+size_t BatchProgress::abandon() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t abandoned = in_flight_.size();
+    in_flight_.clear();
+    return abandoned;
+}
+
+size_t BatchProgress::inFlight() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return in_flight_.size();
+}
+
+void BatchProgress::finishIfDone(const std::string& file) {
+    auto it = in_flight_.find(file);
+    if (it == in_flight_.end() || !it->second.ingest_finished ||
+        it->second.clips_completed < it->second.clips_submitted) {
+        return;
+    }
+
+    // Counted before the callback so it sees itself in the totals
+    if (it->second.clips_failed == 0) {
+        files_indexed_++;
+    } else {
+        files_failed_++;
+    }
+    if (on_file_done_) {
+        on_file_done_(file, it->second);
+    }
+
+    in_flight_.erase(it);
+    done_cv_.notify_all();
+}
+
+}
@@ -1,19 +1,87 @@
 #include "../include/VideoAnalysisEngine.hpp"
 
+#include <filesystem>
+
 namespace nl_video_analysis {
 
 VideoAnalysisEngine::VideoAnalysisEngine(const VideoAnalysisConfig& config)
     : config_(config), is_running_(false) {
-    frame_sampler_ = std::make_unique<UniformFrameSampler>();
-    object_detector_ = std::make_unique<YOLOXDetector>(config_.object_detector.weights_path, config_.object_detector.number_of_threads, config_.object_detector.is_fp16, config_.object_detector.classes);
-    tracker_ = std::make_unique<nl_video_analysis::SortTracker>(config_.tracker.max_age, config_.tracker.min_hits, config_.tracker.iou_threshold);
-    clip_image_encoder_ = std::make_unique<nl_video_analysis::CLIPImageEncoder>(config_.image_encoder.model_path, config_.image_encoder.num_threads, config_.image_encoder.is_fp16); 
-    storage_handler_ = std::make_unique<nl_video_analysis::MilvusStorageHandler>(config_.storage_handler.clip_storage_type, 
-                                                                                 config_.storage_handler.clip_storage_path,
-                                                                                 config_.storage_handler.db_host,
-                                                                                 config_.storage_handler.db_port,
-                                                                                 config_.storage_handler.db_user,
-                                                                                 config_.storage_handler.db_password);
+    frame_sampler_ = FrameSamplerRegistry::getInstance().create(config_.sampler_type);
+    if (!frame_sampler_) {
+        LOG_WARN("Unknown sampler_type '{}', using uniform sampling", config_.sampler_type);
+        frame_sampler_ = std::make_unique<UniformFrameSampler>();
+    }
+    if (config_.sample_at_decode && config_.sampler_type != "uniform") {
+        LOG_WARN("sample_at_decode plans frames uniformly; sampler_type '{}' only applies to clips with full-rate frames",
+                 config_.sampler_type);
+    }
+    if (config_.motion_gate) {
+        motion_gate_ = std::make_unique<MotionGate>(config_.motion_pixel_threshold, config_.motion_min_changed_fraction);
+    }
+
+    if (config_.ort_global_thread_pool) {
+        // Has to happen before the first model session creates the ONNX Runtime environment
+        OrtGlobalThreadPoolOptions pool;
+        pool.enabled = true;
+        pool.intra_op_threads = config_.ort_intra_op_threads;
+        pool.inter_op_threads = config_.ort_inter_op_threads;
+        pool.allow_spinning = config_.ort_allow_spinning;
+        pool.intra_op_affinity = config_.ort_intra_op_affinity;
+        ONNXSessionBuilder::setGlobalThreadPool(pool);
+    }
+
+    auto camera_key = [](const ClipWorkItem& item) { return item.clip.camera_id; };
+    size_t detection_workers = static_cast<size_t>(std::max(1, config_.detection_workers));
+    size_t stage_queue_size = static_cast<size_t>(std::max(1, config_.stage_queue_size));
+
+    // The ingest-facing queue budget is split across detection workers so total buffering stays at queue_max_size
+    size_t detection_queue_size = (static_cast<size_t>(config_.queue_max_size) + detection_workers - 1) / detection_workers;
+
+    detection_stage_ = std::make_unique<PipelineStage<ClipWorkItem>>("detection", detection_workers, detection_queue_size, camera_key);
+    tracking_stage_ = std::make_unique<PipelineStage<ClipWorkItem>>("tracking", config_.tracking_workers, stage_queue_size, camera_key);
+    embedding_stage_ = std::make_unique<PipelineStage<ClipWorkItem>>("embedding", config_.embedding_workers, stage_queue_size, camera_key);
+    storage_stage_ = std::make_unique<PipelineStage<ClipWorkItem>>("storage", config_.storage_workers, stage_queue_size, camera_key);
+
+    // Without shared sessions every context loads its own copy of the model (and its own thread pool)
+    std::shared_ptr<Ort::Session> detector_session;
+    std::shared_ptr<Ort::Session> encoder_session;
+    if (config_.share_model_sessions) {
+        detector_session = ONNXSessionBuilder(config_.object_detector.weights_path, config_.object_detector.number_of_threads).build();
+        encoder_session = ONNXSessionBuilder(config_.image_encoder.model_path, config_.image_encoder.num_threads).build();
+        LOG_INFO("Sharing one detector and one image encoder session across {} and {} worker(s)",
+                 detection_stage_->getNumWorkers(), embedding_stage_->getNumWorkers());
+    }
+
+    detector_pool_ = std::make_unique<ModelPool<YOLOXDetector>>(detection_stage_->getNumWorkers(), [&](size_t) {
+        const auto& cfg = config_.object_detector;
+        auto detector = detector_session
+            ? std::make_unique<YOLOXDetector>(detector_session, cfg.is_fp16, cfg.classes, cfg.max_batch_size)
+            : std::make_unique<YOLOXDetector>(cfg.weights_path, cfg.number_of_threads, cfg.is_fp16, cfg.classes, cfg.max_batch_size);
+        detector->setClassAgnosticNms(cfg.class_agnostic_nms);
+        detector->setIoBinding(cfg.io_binding);
+        return detector;
+    });
+    trackers_.resize(tracking_stage_->getNumWorkers());
+    encoder_pool_ = std::make_unique<ModelPool<CLIPImageEncoder>>(embedding_stage_->getNumWorkers(), [&](size_t) {
+        const auto& cfg = config_.image_encoder;
+        auto encoder = encoder_session
+            ? std::make_unique<CLIPImageEncoder>(encoder_session, cfg.is_fp16, cfg.max_batch_size)
+            : std::make_unique<CLIPImageEncoder>(cfg.model_path, cfg.num_threads, cfg.is_fp16, cfg.max_batch_size);
+        encoder->setIoBinding(cfg.io_binding);
+        return encoder;
+    });
+    for (size_t i = 0; i < storage_stage_->getNumWorkers(); ++i) {
+        storage_handlers_.push_back(std::make_unique<nl_video_analysis::MilvusStorageHandler>(config_.storage_handler.clip_storage_type, 
+                                                                                              config_.storage_handler.clip_storage_path,
+                                                                                              config_.storage_handler.db_host,
+                                                                                              config_.storage_handler.db_port,
+                                                                                              config_.storage_handler.db_user,
+                                                                                              config_.storage_handler.db_password));
+    }
+
+    LOG_INFO("Pipeline stages: detection x{}, tracking x{}, embedding x{}, storage x{}",
+             detection_stage_->getNumWorkers(), tracking_stage_->getNumWorkers(),
+             embedding_stage_->getNumWorkers(), storage_stage_->getNumWorkers());
 }
 
 VideoAnalysisEngine::~VideoAnalysisEngine() {
@@ -23,7 +91,8 @@ VideoAnalysisEngine::~VideoAnalysisEngine() {
 bool VideoAnalysisEngine::addSource(const std::string& source_url,
                                     const std::string& camera_id,
                                     const std::string& source_type,
-                                    const StreamCodec& stream_codec) {
+                                    const StreamCodec& stream_codec,
+                                    DecodeMode decode_mode) {
     if (stream_handlers_.size() >= static_cast<size_t>(config_.max_connections)) {
         LOG_ERROR("Maximum connections reached ({})", config_.max_connections);
         return false;
@@ -32,16 +101,29 @@ bool VideoAnalysisEngine::addSource(const std::string& source_url,
     std::unique_ptr<IStreamHandler> handler;
 
     if (source_type == "rtsp") {
-        handler = std::make_unique<GStreamerRTSPHandler>(
+        auto rtsp_handler = std::make_unique<GStreamerRTSPHandler>(
             config_.clip_length,
             config_.queue_max_size,
             config_.gst_target_fps,
             config_.gst_frame_width,
             config_.gst_frame_height,
-            stream_codec
+            stream_codec,
+            GstPipelineBuilder::parseBackend(config_.gst_decode_backend),
+            config_.gst_decoder_threads
         );
+        rtsp_handler->setDecodeMode(decode_mode);
+        rtsp_handler->setClipStride(config_.clip_stride_ms);
+        handler = std::move(rtsp_handler);
     } else if (source_type == "file") {
-        handler = std::make_unique<OpenCVFileHandler>(config_.clip_length);
+        if (decode_mode != DecodeMode::All) {
+            LOG_WARN("Decode modes only apply to RTSP sources, file source will decode every frame");
+        }
+        if (config_.clip_stride_ms > 0) {
+            LOG_WARN("clip_stride_ms only applies to RTSP sources, file source clips stay disjoint");
+        }
+        auto file_handler = std::make_unique<OpenCVFileHandler>(config_.clip_length);
+        file_handler->setParallelDecode(config_.file_decode_workers, config_.file_decode_ordered);
+        handler = std::move(file_handler);
     } else {
         LOG_ERROR("Unknown source type: {}", source_type);
         return false;
@@ -50,10 +132,25 @@ bool VideoAnalysisEngine::addSource(const std::string& source_url,
     std::string final_camera_id = camera_id.empty() ?
         "camera_" + std::to_string(stream_handlers_.size() + 1) : camera_id;
 
+    if (config_.sample_at_decode && !handler->setDecodeSampling(config_.sampled_frames_count)) {
+        LOG_WARN("Source type '{}' cannot sample at decode time, sampling full clips instead", source_type);
+    }
+
+    if (config_.remux_recording && config_.storage_handler.clip_storage_type == "disk") {
+        std::string recording_dir = (std::filesystem::path(config_.storage_handler.clip_storage_path) / final_camera_id).string();
+        if (!handler->setSegmentRecording(recording_dir)) {
+            LOG_WARN("Source type '{}' cannot record its stream, clips will be re-encoded", source_type);
+        }
+    }
+
     if (handler->startStream(source_url)) {
         stream_handlers_.push_back(std::move(handler));
         camera_ids_.push_back(final_camera_id);
         LOG_INFO("Camera '{}' added (type: {})", final_camera_id, source_type);
+
+        if (is_running_) {
+            startIngestThread(stream_handlers_.size() - 1);
+        }
         return true;
     }
 
@@ -71,13 +168,40 @@ void VideoAnalysisEngine::start() {
         return;
     }
 
+    startStages();
+
+    for (size_t i = 0; i < stream_handlers_.size(); ++i) {
+        startIngestThread(i);
+    }
+
+    LOG_INFO("Pipeline started ({} camera(s))", stream_handlers_.size());
+}
+
+void VideoAnalysisEngine::startProcessing() {
+    if (is_running_) {
+        return;
+    }
+
+    startStages();
+    LOG_INFO("Pipeline started (externally fed)");
+}
+
+void VideoAnalysisEngine::startStages() {
     is_running_ = true;
     clips_processed_ = 0;
-    processing_threads_.emplace_back(&VideoAnalysisEngine::clipProcessingLoop, this);
-    processing_threads_.emplace_back(&VideoAnalysisEngine::objectProcessingLoop, this);
-    processing_threads_.emplace_back(&VideoAnalysisEngine::benchmarkReportingLoop, this);
+    clips_dropped_ = 0;
+    clips_idle_ = 0;
 
-    LOG_INFO("Pipeline started ({} camera(s))", stream_handlers_.size());
+    // A clip a stage fails on never reaches storage, so it is reported as completed (unprocessed) here
+    auto on_error = [this](size_t, ClipWorkItem& item, const std::exception&) { notifyClipCompleted(item.clip, false); };
+
+    // Downstream stages start first so nothing is ever pushed into a stage without workers
+    storage_stage_->start([this](size_t worker, ClipWorkItem& item) { storeClip(worker, item); }, on_error);
+    embedding_stage_->start([this](size_t worker, ClipWorkItem& item) { embedObjects(worker, item); }, on_error);
+    tracking_stage_->start([this](size_t worker, ClipWorkItem& item) { trackObjects(worker, item); }, on_error);
+    detection_stage_->start([this](size_t worker, ClipWorkItem& item) { detectObjects(worker, item); }, on_error);
+
+    processing_threads_.emplace_back(&VideoAnalysisEngine::benchmarkReportingLoop, this);
 }
 
 void VideoAnalysisEngine::stop() {
@@ -86,11 +210,27 @@ void VideoAnalysisEngine::stop() {
     }
     is_running_ = false;
 
+    // Stopping the handlers unblocks ingest threads waiting in getNextClip()
     for (auto& handler : stream_handlers_) {
         handler->stopStream();
     }
 
-    clip_queue_cv_.notify_all();
+    for (auto& thread : ingest_threads_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+    ingest_threads_.clear();
+
+    // Stages stop upstream first; pending clips are discarded so shutdown only waits for in-flight work
+    size_t discarded = 0;
+    discarded += detection_stage_->stop();
+    discarded += tracking_stage_->stop();
+    discarded += embedding_stage_->stop();
+    discarded += storage_stage_->stop();
+    if (discarded > 0) {
+        LOG_INFO("Discarded {} queued clip(s) on shutdown", discarded);
+    }
 
     for (auto& thread : processing_threads_) {
         if (thread.joinable()) {
@@ -113,97 +253,206 @@ bool VideoAnalysisEngine::isRunning() const {
     return is_running_;
 }
 
-void VideoAnalysisEngine::clipProcessingLoop() {
-    while (is_running_) {
-        for (size_t i = 0; i < stream_handlers_.size(); ++i) {
-            auto& handler = stream_handlers_[i];
-            if (handler->isActive()) {
-                std::optional<ClipContainer> clip;
-
-                // Benchmark clip retrieval (includes network/file I/O latency)
-                {
-                    ScopedTimer timer("clip_retrieval", camera_ids_[i]);
-                    clip = handler->getNextClip();
-                }
-
-                if (clip.has_value()) {
-                    clip.value().camera_id = camera_ids_[i];
-
-                    // Benchmark frame sampling (actual processing only)
-                    {
-                        ScopedTimer timer("frame_sampling", camera_ids_[i]);
-                        frame_sampler_->sampleFrames(clip.value(), config_.sampled_frames_count);
-                    }
-
-                    std::unique_lock<std::mutex> lock(clip_queue_mutex_);
-                    if (clip_queue_.size() < static_cast<size_t>(config_.queue_max_size)) {
-                        clip_queue_.push(std::move(clip.value()));
-                        clip_queue_cv_.notify_one();
-                    } else {
-                        LOG_WARN("Queue full, dropping clip from camera '{}'", camera_ids_[i]);
-                    }
-                }
-            }
+void VideoAnalysisEngine::startIngestThread(size_t handler_index) {
+    // The thread gets its own handle and id so later addSource() calls can grow the vectors safely
+    ingest_threads_.emplace_back(&VideoAnalysisEngine::ingestLoop, this,
+                                 stream_handlers_[handler_index].get(), camera_ids_[handler_index]);
+}
+
+void VideoAnalysisEngine::ingestLoop(IStreamHandler* handler, const std::string camera_id) {
+    const auto push_timeout = std::chrono::milliseconds(config_.queue_push_timeout_ms);
+
+    std::optional<std::chrono::steady_clock::time_point> last_clip_time;
+
+    while (is_running_ && handler->isActive()) {
+        std::optional<ClipContainer> clip;
+
+        // Benchmark clip retrieval (includes network/file I/O latency)
+        {
+            ScopedTimer timer("clip_retrieval", camera_id);
+            clip = handler->getNextClip();
+        }
+
+        if (!clip.has_value()) {
+            continue;
+        }
+
+        // Time between consecutive clips of this camera; drifts upwards when the source falls behind
+        auto now = std::chrono::steady_clock::now();
+        if (last_clip_time) {
+            PipelineBenchmark::getInstance().recordTiming(
+                "clip_interval", std::chrono::duration<double, std::milli>(now - *last_clip_time).count(), camera_id);
+        }
+        last_clip_time = now;
+
+        clip.value().camera_id = camera_id;
+
+        // Blocks while processing is behind; only drops once the back-pressure window expires
+        QueueStatus status = enqueueClip(std::move(clip.value()), push_timeout);
+
+        if (status == QueueStatus::Timeout) {
+            clips_dropped_++;
+            LOG_WARN("Clip queue full for {} ms, dropping clip from camera '{}' ({} dropped so far)",
+                     config_.queue_push_timeout_ms, camera_id, clips_dropped_.load());
+        } else if (status == QueueStatus::Closed) {
+            break;
         }
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
     }
+
+    LOG_INFO("Ingest for camera '{}' finished", camera_id);
 }
 
-void VideoAnalysisEngine::objectProcessingLoop() {
-    while (is_running_) {
-        ClipContainer clip;
-        if (!getNextClip(clip)) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
-            continue;
+QueueStatus VideoAnalysisEngine::enqueueClip(ClipContainer&& clip, std::chrono::milliseconds timeout) {
+    const std::string camera_id = clip.camera_id;
+
+    // Clips sampled at decode time arrive with sampled_frames already filled and no full-rate frames
+    if (!clip.frames.empty()) {
+        ScopedTimer timer("frame_sampling", camera_id);
+        frame_sampler_->sampleFrames(clip, config_.sampled_frames_count);
+    }
+
+    ClipWorkItem item;
+    if (motion_gate_) {
+        ScopedTimer timer("motion_gate", camera_id);
+        MotionGateResult motion = motion_gate_->evaluate(clip);
+        clip.metadata["activity"] = std::to_string(motion.activity);
+        item.idle = motion.idle;
+    }
+
+    if (item.idle) {
+        clips_idle_++;
+        if (!config_.archive_idle_clips) {
+            notifyClipCompleted(clip, true);
+            return QueueStatus::Ok;
         }
+        clip.metadata["idle"] = "true";
+    }
 
-        ScopedTimer clip_timer("clip_total_processing", clip.camera_id);
-        std::vector<std::vector<Detection>> all_detections;
-        {
-            ScopedTimer detection_timer("clip_object_detection", clip.camera_id);
-            all_detections.reserve(clip.sampled_frames.size());
-
-            for (const auto& frame : clip.sampled_frames) {
-                std::vector<Detection> detections = object_detector_->detect(
-                    frame,
-                    config_.object_detector.conf_threshold,
-                    config_.object_detector.nms_threshold
-                );
-                all_detections.push_back(std::move(detections));
-            }
+    // Idle clips still travel through every stage so a camera's clips reach storage in order
+    ScopedTimer timer("clip_enqueue", camera_id);
+    item.clip = std::move(clip);
+    return detection_stage_->submit(std::move(item), timeout);
+}
+
+bool VideoAnalysisEngine::submitClip(ClipContainer&& clip) {
+    if (!is_running_) {
+        return false;
+    }
+    return enqueueClip(std::move(clip), BlockingQueue<ClipWorkItem>::kWaitForever) == QueueStatus::Ok;
+}
+
+void VideoAnalysisEngine::setClipCompletionCallback(ClipCompletionCallback callback) {
+    completion_callback_ = std::move(callback);
+}
+
+void VideoAnalysisEngine::releaseCamera(const std::string& camera_id) {
+    {
+        std::lock_guard<std::mutex> lock(trackers_mutex_);
+        for (auto& trackers : trackers_) {
+            trackers.erase(camera_id);
+        }
+    }
+    if (motion_gate_) {
+        motion_gate_->reset(camera_id);
+    }
+    for (auto* stage : {detection_stage_.get(), tracking_stage_.get(), embedding_stage_.get(), storage_stage_.get()}) {
+        if (stage) {
+            stage->forget(camera_id);
         }
+    }
+    PipelineBenchmark::getInstance().removeCamera(camera_id);
+}
+
+void VideoAnalysisEngine::notifyClipCompleted(const ClipContainer& clip, bool processed) {
+    if (completion_callback_) {
+        completion_callback_(clip, processed);
+    }
+}
+
+void VideoAnalysisEngine::detectObjects(size_t worker_index, ClipWorkItem& item) {
+    if (item.idle) {
+        tracking_stage_->submit(std::move(item));
+        return;
+    }
 
-        std::vector<std::vector<nlohmann::json>> all_tracked_objects;
-        all_tracked_objects.reserve(all_detections.size());
+    ScopedTimer detection_timer("clip_object_detection", item.clip.camera_id);
+    auto detector = detector_pool_->acquire();
+    item.detections = detector->detectBatch(
+        item.clip.sampled_frames,
+        config_.object_detector.conf_threshold,
+        config_.object_detector.nms_threshold
+    );
+    tracking_stage_->submit(std::move(item));
+}
 
-        for (const auto& detections : all_detections) {
-            std::vector<nlohmann::json> tracked_objects = tracker_->track(detections);
-            all_tracked_objects.push_back(std::move(tracked_objects));
+void VideoAnalysisEngine::trackObjects(size_t worker_index, ClipWorkItem& item) {
+    if (item.idle) {
+        embedding_stage_->submit(std::move(item));
+        return;
+    }
+
+    // Each camera is routed to a single tracking worker, so its tracker is never shared between threads
+    ClipTracker* tracker = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(trackers_mutex_);
+        auto& trackers = trackers_[worker_index];
+        auto it = trackers.find(item.clip.camera_id);
+        if (it == trackers.end()) {
+            it = trackers.emplace(item.clip.camera_id, std::make_unique<ClipTracker>(
+                config_.tracker.max_age, config_.tracker.min_hits, config_.tracker.iou_threshold)).first;
         }
-        std::string base_path = "/home/nvidia/projects/NaturalLanguage-VisionAnalysis/test_cropps/";
-        std::map<int64_t, std::vector<std::vector<float>>> tracklet_to_embeddings;
-        for (size_t i = 0; i < clip.sampled_frames.size(); ++i) {
-            const auto& frame = clip.sampled_frames[i];
-            const auto& tracked_objects = all_tracked_objects[i];
-
-            for (const auto& tracklet : tracked_objects) {
-                auto bbox = tracklet["BoundingBox"];
-                int64_t tracker_id = tracklet["TrackerId"].get<int64_t>();
-
-                std::optional<cv::Mat> cropped = crop_object(
-                    frame,
-                    bbox[0], bbox[1], bbox[2], bbox[3],
-                    10
-                );
-                if (cropped) {
-                    std::vector<float> embedding = clip_image_encoder_->encode(cropped.value());
-                    tracklet_to_embeddings[tracker_id].push_back(embedding);
-                }
+        tracker = it->second.get();
+    }
+
+    // Overlapping clips share frames; the tracker only advances past what the previous clip covered
+    item.tracked_objects = tracker->track(item.detections, ClipTracker::sampledFrameTimestamps(item.clip));
+    embedding_stage_->submit(std::move(item));
+}
+
+void VideoAnalysisEngine::embedObjects(size_t worker_index, ClipWorkItem& item) {
+    if (item.idle) {
+        storage_stage_->submit(std::move(item));
+        return;
+    }
+
+    ScopedTimer embedding_timer("clip_embedding", item.clip.camera_id);
+
+    // Gather every tracked crop of the clip so they are encoded in as few batches as possible
+    std::vector<cv::Mat> crops;
+    std::vector<int64_t> crop_tracker_ids;
+    for (size_t i = 0; i < item.clip.sampled_frames.size() && i < item.tracked_objects.size(); ++i) {
+        const auto& frame = item.clip.sampled_frames[i];
+
+        for (const auto& tracklet : item.tracked_objects[i]) {
+            auto bbox = tracklet["BoundingBox"];
+            int64_t tracker_id = tracklet["TrackerId"].get<int64_t>();
+
+            std::optional<cv::Mat> cropped = crop_object(
+                frame,
+                bbox[0], bbox[1], bbox[2], bbox[3],
+                10
+            );
+            if (cropped) {
+                crops.push_back(std::move(cropped.value()));
+                crop_tracker_ids.push_back(tracker_id);
             }
         }
-        storage_handler_->saveClip(clip, tracklet_to_embeddings);
+    }
+
+    std::vector<std::vector<float>> embeddings = encoder_pool_->acquire()->encodeBatch(crops);
+    for (size_t i = 0; i < embeddings.size(); ++i) {
+        item.embeddings[crop_tracker_ids[i]].push_back(std::move(embeddings[i]));
+    }
+    storage_stage_->submit(std::move(item));
+}
+
+void VideoAnalysisEngine::storeClip(size_t worker_index, ClipWorkItem& item) {
+    // An empty path means the clip was not written, so it counts as failed (a batch file is then retried)
+    std::string path = storage_handlers_[worker_index]->saveClip(item.clip, item.embeddings);
+    if (!path.empty()) {
         clips_processed_++;
     }
+    notifyClipCompleted(item.clip, !path.empty());
 }
 
 void VideoAnalysisEngine::benchmarkReportingLoop() {
@@ -216,22 +465,36 @@ void VideoAnalysisEngine::benchmarkReportingLoop() {
 
         // Generate and log benchmark report
         std::string report = PipelineBenchmark::getInstance().generateReport();
-        LOG_INFO("=== Benchmark Report (Clips Processed: {}) ==={}", clips_processed_.load(), report);
+        LOG_INFO("=== Benchmark Report (Clips Processed: {}, Dropped: {}, Idle: {}) ==={}",
+                 clips_processed_.load(), clips_dropped_.load(), clips_idle_.load(), report);
+        logStageStats(*detection_stage_);
+        logStageStats(*tracking_stage_);
+        logStageStats(*embedding_stage_);
+        logStageStats(*storage_stage_);
+    }
+}
+
+void VideoAnalysisEngine::logStageStats(const PipelineStage<ClipWorkItem>& stage) const {
+    std::vector<QueueStats> all_stats = stage.getQueueStats();
+    for (size_t i = 0; i < all_stats.size(); ++i) {
+        const QueueStats& stats = all_stats[i];
+        LOG_INFO("[{}#{}] depth {}/{} (high watermark {}), pushed {}, popped {}, rejected {}, "
+                 "avg queued {:.2f} ms, producer wait {:.1f} ms, consumer wait {:.1f} ms",
+                 stage.getName(), i, stats.depth, stats.capacity, stats.high_watermark, stats.pushed, stats.popped,
+                 stats.rejected, stats.getAverageQueuedMs(), stats.total_push_wait_ms, stats.total_pop_wait_ms);
     }
 }
 
 size_t VideoAnalysisEngine::getClipQueueSize() const {
-    std::lock_guard<std::mutex> lock(clip_queue_mutex_);
-    return clip_queue_.size();
+    return detection_stage_->getQueueSize();
 }
 
 bool VideoAnalysisEngine::getNextClip(ClipContainer& clip) {
-    std::lock_guard<std::mutex> lock(clip_queue_mutex_);
-    if (clip_queue_.empty()) {
+    ClipWorkItem item;
+    if (!detection_stage_->tryTake(item)) {
         return false;
     }
-    clip = std::move(clip_queue_.front());
-    clip_queue_.pop();
+    clip = std::move(item.clip);
     return true;
 }
 
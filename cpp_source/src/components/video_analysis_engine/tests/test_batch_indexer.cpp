@@ -0,0 +1,201 @@
+#define CATCH_CONFIG_MAIN
+#include "../../../lib/catch2/catch_amalgamated.hpp"
+#include "BatchIndexer.hpp"
+#include "BatchProgress.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+using namespace nl_video_analysis;
+
+namespace fs = std::filesystem;
+
+static void touch(const fs::path& path, const std::string& contents = "") {
+    fs::create_directories(path.parent_path());
+    std::ofstream file(path);
+    file << contents;
+}
+
+TEST_CASE("BatchIndexer lists video files", "[batch_indexer]") {
+    fs::path dir = "/tmp/test_batch_indexer_files";
+    fs::remove_all(dir);
+    touch(dir / "b.mp4");
+    touch(dir / "a.mov");
+    touch(dir / "notes.txt");
+    touch(dir / ".nl_index_checkpoint");
+    touch(dir / "cam2" / "Night.MKV");
+    touch(dir / "cam2" / "archive" / "old.avi");
+    fs::create_directories(dir / "empty.mp4");
+
+    SECTION("Recursively, relative to the directory and sorted") {
+        auto files = BatchIndexer::listVideoFiles(dir.string(), BatchIndexerOptions{}.extensions);
+        REQUIRE(files == std::vector<std::string>{"a.mov", "b.mp4", "cam2/Night.MKV", "cam2/archive/old.avi"});
+    }
+
+    SECTION("Only the requested extensions") {
+        auto files = BatchIndexer::listVideoFiles(dir.string(), {".mp4"});
+        REQUIRE(files == std::vector<std::string>{"b.mp4"});
+    }
+
+    SECTION("Missing directory") {
+        REQUIRE(BatchIndexer::listVideoFiles((dir / "missing").string(), {".mp4"}).empty());
+    }
+
+    fs::remove_all(dir);
+}
+
+TEST_CASE("BatchIndexer loads the checkpoint", "[batch_indexer]") {
+    fs::path path = "/tmp/test_batch_indexer_checkpoint";
+
+    SECTION("One file per line, blank lines skipped") {
+        touch(path, "a.mov\ncam2/Night.MKV\n\na.mov\nb.mp4");
+        auto completed = BatchIndexer::loadCheckpoint(path.string());
+        REQUIRE(completed == std::set<std::string>{"a.mov", "b.mp4", "cam2/Night.MKV"});
+    }
+
+    SECTION("Missing checkpoint") {
+        fs::remove(path);
+        REQUIRE(BatchIndexer::loadCheckpoint(path.string()).empty());
+    }
+
+    fs::remove(path);
+}
+
+struct DoneFile {
+    std::string file;
+    BatchFileProgress progress;
+};
+
+TEST_CASE("BatchProgress reports a file once every clip has completed", "[batch_indexer][batch_progress]") {
+    std::vector<DoneFile> done;
+    BatchProgress progress([&done](const std::string& file, const BatchFileProgress& file_progress) {
+        done.push_back({file, file_progress});
+    });
+
+    progress.startFile("a.mp4");
+    progress.clipSubmitted("a.mp4");
+    progress.clipSubmitted("a.mp4");
+    progress.clipCompleted("a.mp4", true);
+
+    SECTION("Clips still in the pipeline when ingest finishes") {
+        progress.finishIngest("a.mp4");
+        REQUIRE(done.empty());
+        REQUIRE(progress.inFlight() == 1);
+
+        progress.clipCompleted("a.mp4", true);
+        REQUIRE(done.size() == 1);
+        REQUIRE(done[0].file == "a.mp4");
+        REQUIRE(done[0].progress.clips_completed == 2);
+        REQUIRE(done[0].progress.clips_failed == 0);
+        REQUIRE(progress.inFlight() == 0);
+        REQUIRE(progress.filesIndexed() == 1);
+        REQUIRE(progress.clipsProcessed() == 2);
+    }
+
+    SECTION("Every clip completed before ingest finishes") {
+        // Completed clips catching up with submitted ones is not enough while the reader may submit more
+        progress.clipCompleted("a.mp4", true);
+        REQUIRE(done.empty());
+
+        progress.finishIngest("a.mp4");
+        REQUIRE(done.size() == 1);
+        REQUIRE(progress.filesIndexed() == 1);
+    }
+
+    SECTION("A failed clip fails the file") {
+        progress.clipCompleted("a.mp4", false);
+        progress.finishIngest("a.mp4");
+        REQUIRE(done.size() == 1);
+        REQUIRE(done[0].progress.clips_failed == 1);
+        REQUIRE(progress.filesIndexed() == 0);
+        REQUIRE(progress.filesFailed() == 1);
+        REQUIRE(progress.clipsProcessed() == 1);
+    }
+}
+
+TEST_CASE("BatchProgress counts a clip that completes before it is submitted", "[batch_indexer][batch_progress]") {
+    size_t done = 0;
+    BatchProgress progress([&done](const std::string&, const BatchFileProgress&) { done++; });
+
+    progress.startFile("a.mp4");
+    for (int i = 0; i < 3; ++i) {
+        // The reader counts the clip first; the pipeline finishes it before submitClip() returns
+        progress.clipSubmitted("a.mp4");
+        progress.clipCompleted("a.mp4", true);
+        REQUIRE(done == 0);
+    }
+
+    progress.finishIngest("a.mp4");
+    REQUIRE(done == 1);
+    REQUIRE(progress.clipsProcessed() == 3);
+}
+
+TEST_CASE("BatchProgress leaves interrupted files out", "[batch_indexer][batch_progress]") {
+    size_t done = 0;
+    BatchProgress progress([&done](const std::string&, const BatchFileProgress&) { done++; });
+
+    progress.startFile("a.mp4");
+    progress.clipSubmitted("a.mp4");
+    progress.clipSubmitted("a.mp4");
+    progress.clipRejected("a.mp4");  // the engine stopped while the second clip was submitted
+    progress.clipCompleted("a.mp4", true);
+
+    // The reader stopped without finishing ingest, so the file is never reported
+    std::atomic<bool> running{false};
+    REQUIRE_FALSE(progress.waitUntilDone(running));
+    REQUIRE(done == 0);
+    REQUIRE(progress.filesIndexed() == 0);
+    REQUIRE(progress.abandon() == 1);
+    REQUIRE(progress.inFlight() == 0);
+
+    // Late completions of a dropped file are ignored
+    progress.clipCompleted("a.mp4", true);
+    REQUIRE(done == 0);
+}
+
+TEST_CASE("BatchProgress counts files that cannot be opened", "[batch_indexer][batch_progress]") {
+    BatchProgress progress;
+    progress.fileFailed();
+    REQUIRE(progress.filesFailed() == 1);
+    REQUIRE(progress.inFlight() == 0);
+}
+
+TEST_CASE("BatchProgress with concurrent readers and workers", "[batch_indexer][batch_progress]") {
+    std::mutex done_mutex;
+    std::vector<std::string> done;
+    size_t clips_completed = 0;
+    BatchProgress progress([&](const std::string& file, const BatchFileProgress& file_progress) {
+        std::lock_guard<std::mutex> lock(done_mutex);
+        done.push_back(file);
+        clips_completed += file_progress.clips_completed;
+    });
+
+    const std::vector<std::string> files = {"a.mp4", "b.mp4", "c.mp4", "d.mp4"};
+    std::vector<std::thread> readers;
+    for (const auto& file : files) {
+        readers.emplace_back([&progress, file] {
+            progress.startFile(file);
+            std::vector<std::thread> workers;
+            for (int i = 0; i < 50; ++i) {
+                progress.clipSubmitted(file);
+                workers.emplace_back([&progress, file] { progress.clipCompleted(file, true); });
+            }
+            progress.finishIngest(file);
+            for (auto& worker : workers) {
+                worker.join();
+            }
+        });
+    }
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    std::atomic<bool> running{true};
+    REQUIRE(progress.waitUntilDone(running));
+    std::sort(done.begin(), done.end());
+    REQUIRE(done == files);
+    REQUIRE(clips_completed == 200);
+    REQUIRE(progress.filesIndexed() == files.size());
+    REQUIRE(progress.clipsProcessed() == 200);
+}
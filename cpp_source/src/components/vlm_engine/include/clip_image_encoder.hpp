@@ -10,16 +10,33 @@ namespace nl_video_analysis {
 
     class CLIPImageEncoder : public IBaseModel<const cv::Mat&, std::vector<float>> {
         public:
-            CLIPImageEncoder(const std::string& model_path, const int num_threads, bool is_fp16 = false);
+            CLIPImageEncoder(const std::string& model_path, const int num_threads, bool is_fp16 = false,
+                             int max_batch_size = 32);
+            // Another inference context on a loaded session (see ModelPool): shares the weights, not the buffers
+            CLIPImageEncoder(std::shared_ptr<Ort::Session> session, bool is_fp16 = false, int max_batch_size = 32);
             std::vector<float> encode(const cv::Mat& iFrame);
+
+            // Encodes all crops as [B,3,S,S] batches of at most max_batch_size crops
+            // (the exported batch size for fixed-batch models). Returns one L2-normalized
+            // embedding per crop, in input order.
+            std::vector<std::vector<float>> encodeBatch(const std::vector<cv::Mat>& crops);
             ~CLIPImageEncoder() override = default;
 
+            int getMaxBatchSize() const { return max_batch_size_; }
+
         protected:
             std::vector<Ort::Value> preprocess(const cv::Mat& input) override;
             std::vector<float> postprocess(std::vector<Ort::Value>& output_tensors) override;
 
         private:
+            void preprocessCrop(const cv::Mat& input, float* dst);
+            std::vector<Ort::Value> createInputTensor(int64_t batch_size);
+            const float* outputAsFloat(Ort::Value& output_tensor, size_t& output_size);
+            static void normalize(float* embedding, size_t embedding_size);
+
             bool is_fp16_;
+            bool has_dynamic_batch_;
+            int max_batch_size_;
             int target_size_ = 224;
 
             const std::vector<float> mean_ = {0.48145466f, 0.4578275f, 0.40821073f};
@@ -30,6 +47,7 @@ namespace nl_video_analysis {
             // Member variables to persist tensor data (similar to YOLOXDetector)
             std::vector<Ort::Float16_t> input_data_fp16_;
             std::vector<float> input_data_fp32_;
+            std::vector<float> output_data_fp32_;
     };
 }
 
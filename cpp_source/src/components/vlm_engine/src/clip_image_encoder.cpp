@@ -4,8 +4,14 @@
 
 namespace nl_video_analysis {
 
-    CLIPImageEncoder::CLIPImageEncoder(const std::string& model_path, const int num_threads, bool is_fp16)
-        : IBaseModel<const cv::Mat&, std::vector<float>>(model_path, num_threads),
+    CLIPImageEncoder::CLIPImageEncoder(const std::string& model_path, const int num_threads, bool is_fp16,
+                                       int max_batch_size)
+        : CLIPImageEncoder(ONNXSessionBuilder(model_path, num_threads).build(), is_fp16, max_batch_size)
+    {
+    }
+
+    CLIPImageEncoder::CLIPImageEncoder(std::shared_ptr<Ort::Session> session, bool is_fp16, int max_batch_size)
+        : IBaseModel<const cv::Mat&, std::vector<float>>(std::move(session)),
           is_fp16_(is_fp16)
     {
         Ort::AllocatorWithDefaultOptions allocator;
@@ -17,16 +23,72 @@ namespace nl_video_analysis {
             throw std::runtime_error("Expected 4D input tensor for CLIP image encoder");
         }
         target_size_ = static_cast<int>(input_shape_[2]);
-        LOG_INFO("CLIPImageEncoder initialized with target size: {}x{}", target_size_, target_size_);
+
+        has_dynamic_batch_ = input_shape_[0] <= 0;
+        max_batch_size_ = has_dynamic_batch_ ? std::max(1, max_batch_size) : static_cast<int>(input_shape_[0]);
+        LOG_INFO("CLIPImageEncoder initialized with target size: {}x{}, {} batch (max {})", target_size_, target_size_,
+                 has_dynamic_batch_ ? "dynamic" : "fixed", max_batch_size_);
     }
     std::vector<float> CLIPImageEncoder::encode(const cv::Mat& iFrame)
     {
         return this->run(iFrame);        
     }
 
+    std::vector<std::vector<float>> CLIPImageEncoder::encodeBatch(const std::vector<cv::Mat>& crops)
+    {
+        std::vector<std::vector<float>> embeddings;
+        embeddings.reserve(crops.size());
+
+        const size_t chunk_size = static_cast<size_t>(max_batch_size_);
+        const size_t image_size = 3 * target_size_ * target_size_;
+
+        for (size_t begin = 0; begin < crops.size(); begin += chunk_size) {
+            size_t end = std::min(begin + chunk_size, crops.size());
+            int64_t batch_size = has_dynamic_batch_ ? static_cast<int64_t>(end - begin) : max_batch_size_;
+
+            std::vector<Ort::Value> input_tensors;
+            {
+                nl_video_analysis::ScopedTimer timer("clip_preprocess");
+                // Padded slots of fixed-batch models are zero (the normalized mean) and ignored on output
+                input_data_fp32_.assign(batch_size * image_size, 0.0f);
+                for (size_t i = begin; i < end; ++i) {
+                    preprocessCrop(crops[i], input_data_fp32_.data() + (i - begin) * image_size);
+                }
+                input_tensors = createInputTensor(batch_size);
+            }
+
+            std::vector<Ort::Value>& output_tensors = infer(input_tensors);
+
+            nl_video_analysis::ScopedTimer timer("clip_postprocess");
+            if (output_tensors.empty()) {
+                throw std::runtime_error("No output tensors from CLIP model");
+            }
+
+            size_t output_size = 0;
+            const float* output_data = outputAsFloat(output_tensors[0], output_size);
+            size_t embedding_size = output_size / static_cast<size_t>(batch_size);
+
+            for (size_t i = 0; i < end - begin; ++i) {
+                const float* row = output_data + i * embedding_size;
+                std::vector<float> embedding(row, row + embedding_size);
+                normalize(embedding.data(), embedding.size());
+                embeddings.push_back(std::move(embedding));
+            }
+        }
+
+        return embeddings;
+    }
+
     std::vector<Ort::Value> CLIPImageEncoder::preprocess(const cv::Mat& input) {
         nl_video_analysis::ScopedTimer timer("clip_preprocess");
 
+        input_data_fp32_.resize(3 * target_size_ * target_size_);
+        preprocessCrop(input, input_data_fp32_.data());
+
+        return createInputTensor(1);
+    }
+
+    void CLIPImageEncoder::preprocessCrop(const cv::Mat& input, float* dst) {
         cv::Mat img_rgb;
         cv::cvtColor(input, img_rgb, cv::COLOR_BGR2RGB);
 
@@ -63,29 +125,25 @@ namespace nl_video_analysis {
             channels[i] = (channels[i] - mean_[i]) / std_[i];
         }
 
-        cv::Mat img_normalized;
-        cv::merge(channels, img_normalized);
-
-        std::vector<float> input_tensor_values(1 * 3 * target_size_ * target_size_);
-
         for (int c = 0; c < 3; ++c) {
             for (int h = 0; h < target_size_; ++h) {
                 for (int w = 0; w < target_size_; ++w) {
                     int tensor_idx = c * target_size_ * target_size_ + h * target_size_ + w;
-                    input_tensor_values[tensor_idx] = channels[c].at<float>(h, w);
+                    dst[tensor_idx] = channels[c].at<float>(h, w);
                 }
             }
         }
+    }
 
-        std::vector<int64_t> input_shape = {1, 3, target_size_, target_size_};
+    std::vector<Ort::Value> CLIPImageEncoder::createInputTensor(int64_t batch_size) {
+        std::vector<int64_t> input_shape = {batch_size, 3, target_size_, target_size_};
         std::vector<Ort::Value> tensors;
 
         if (is_fp16_) {
-            std::vector<Ort::Float16_t> input_data_fp16(input_tensor_values.size());
-            for (size_t i = 0; i < input_tensor_values.size(); ++i) {
-                input_data_fp16[i] = Ort::Float16_t(input_tensor_values[i]);
+            input_data_fp16_.resize(input_data_fp32_.size());
+            for (size_t i = 0; i < input_data_fp32_.size(); ++i) {
+                input_data_fp16_[i] = Ort::Float16_t(input_data_fp32_[i]);
             }
-            input_data_fp16_ = std::move(input_data_fp16);
 
             auto tensor = Ort::Value::CreateTensor<Ort::Float16_t>(
                 memory_info_,
@@ -96,8 +154,6 @@ namespace nl_video_analysis {
             );
             tensors.push_back(std::move(tensor));
         } else {
-            input_data_fp32_ = std::move(input_tensor_values);
-
             auto tensor = Ort::Value::CreateTensor<float>(
                 memory_info_,
                 input_data_fp32_.data(),
@@ -111,37 +167,55 @@ namespace nl_video_analysis {
         return tensors;
     }
 
-    std::vector<float> CLIPImageEncoder::postprocess(std::vector<Ort::Value>& output_tensors) {
-        nl_video_analysis::ScopedTimer timer("clip_postprocess");
-
-        if (output_tensors.empty()) {
-            throw std::runtime_error("No output tensors from CLIP model");
-        }
-
-        float* output_data = output_tensors[0].GetTensorMutableData<float>();
-        auto type_info = output_tensors[0].GetTensorTypeAndShapeInfo();
+    const float* CLIPImageEncoder::outputAsFloat(Ort::Value& output_tensor, size_t& output_size) {
+        auto type_info = output_tensor.GetTensorTypeAndShapeInfo();
         auto shape = type_info.GetShape();
 
-        size_t embedding_size = 1;
+        output_size = 1;
         for (auto dim : shape) {
-            embedding_size *= dim;
+            output_size *= dim;
         }
 
-        std::vector<float> embedding(output_data, output_data + embedding_size);
+        if (type_info.GetElementType() != ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16) {
+            return output_tensor.GetTensorMutableData<float>();
+        }
+
+        Ort::Float16_t* output_data_fp16 = output_tensor.GetTensorMutableData<Ort::Float16_t>();
+        output_data_fp32_.resize(output_size);
+        for (size_t i = 0; i < output_size; ++i) {
+            output_data_fp32_[i] = static_cast<float>(output_data_fp16[i]);
+        }
+        return output_data_fp32_.data();
+    }
 
+    void CLIPImageEncoder::normalize(float* embedding, size_t embedding_size) {
         float norm = 0.0f;
-        for (float val : embedding) {
-            norm += val * val;
+        for (size_t i = 0; i < embedding_size; ++i) {
+            norm += embedding[i] * embedding[i];
         }
         norm = std::sqrt(norm);
-        
+
         if (norm > 1e-6f) {
-            for (float& val : embedding) {
-                val /= norm;
+            for (size_t i = 0; i < embedding_size; ++i) {
+                embedding[i] /= norm;
             }
         }
+    }
+
+    std::vector<float> CLIPImageEncoder::postprocess(std::vector<Ort::Value>& output_tensors) {
+        nl_video_analysis::ScopedTimer timer("clip_postprocess");
+
+        if (output_tensors.empty()) {
+            throw std::runtime_error("No output tensors from CLIP model");
+        }
+
+        size_t embedding_size = 0;
+        const float* output_data = outputAsFloat(output_tensors[0], embedding_size);
+
+        std::vector<float> embedding(output_data, output_data + embedding_size);
+        normalize(embedding.data(), embedding.size());
 
         return embedding;
     }
 
-}
\ No newline at end of file
+}
@@ -1,17 +1,66 @@
 #include "clip_image_encoder.hpp"
 #include "../../../../lib/catch2/catch_amalgamated.hpp"
+#include <cmath>
 
 namespace nl_video_analysis {
 
-    CLIPImageEncoder image_encoder()
-    
+    // fp16 model, so every run also goes through the fp16 -> fp32 output conversion
+    const std::string TEST_MODEL_PATH = "/home/nvidia/projects/NaturalLanguage-VisionAnalysis/weights/clip_image_fp16.onnx";
+
+    static std::vector<cv::Mat> makeCrops(size_t count)
+    {
+        std::vector<cv::Mat> crops;
+        cv::RNG rng(11);
+        for (size_t i = 0; i < count; ++i) {
+            // Mixed sizes and aspect ratios, as tracked object crops are
+            cv::Mat crop(40 + 17 * static_cast<int>(i % 5), 30 + 23 * static_cast<int>(i % 3), CV_8UC3);
+            rng.fill(crop, cv::RNG::UNIFORM, cv::Scalar::all(0), cv::Scalar::all(256));
+            crops.push_back(crop);
+        }
+        return crops;
+    }
+
     TEST_CASE("Embeddings with expected length")
     {
-    
-        
-    
-    
-    }    
+        CLIPImageEncoder encoder(TEST_MODEL_PATH, 2, true, 4);
+        auto crops = makeCrops(1);
+
+        auto embedding = encoder.encode(crops[0]);
+        REQUIRE_FALSE(embedding.empty());
+
+        float norm = 0.0f;
+        for (float value : embedding) {
+            REQUIRE(std::isfinite(value));
+            norm += value * value;
+        }
+        REQUIRE(std::sqrt(norm) == Catch::Approx(1.0f).margin(1e-3));
+    }
+
+    TEST_CASE("Batched encoding")
+    {
+        CLIPImageEncoder encoder(TEST_MODEL_PATH, 2, true, 4);
+
+        SECTION("Matches per-crop encoding across several chunks")
+        {
+            // Two full chunks and a partial one
+            auto crops = makeCrops(2 * encoder.getMaxBatchSize() + 1);
+            auto embeddings = encoder.encodeBatch(crops);
+            REQUIRE(embeddings.size() == crops.size());
+
+            for (size_t i = 0; i < crops.size(); ++i) {
+                auto expected = encoder.encode(crops[i]);
+                REQUIRE(embeddings[i].size() == expected.size());
+                for (size_t k = 0; k < expected.size(); ++k) {
+                    // fp16 outputs of different batch shapes may differ in the last bits
+                    REQUIRE(embeddings[i][k] == Catch::Approx(expected[k]).margin(2e-3));
+                }
+            }
+        }
 
+        SECTION("Empty batch returns nothing")
+        {
+            REQUIRE(encoder.encodeBatch({}).empty());
+        }
+    }
 
-}
\ No newline at end of file
+}
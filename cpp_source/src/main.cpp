@@ -1,4 +1,5 @@
 #include "components/video_analysis_engine/include/VideoAnalysisEngine.hpp"
+#include "components/video_analysis_engine/include/BatchIndexer.hpp"
 #include "common/include/config_parser.hpp"
 #include "common/include/logger.hpp"
 #include <iostream>
@@ -6,6 +7,7 @@
 #include <thread>
 #include <csignal>
 #include <atomic>
+#include <cstring>
 
 std::atomic<bool> running(true);
 
@@ -14,19 +16,51 @@ void signalHandler(int signum) {
     running = false;
 }
 
+static int runBatch(const nl_video_analysis::VideoAnalysisConfig& config, const nl_video_analysis::BatchIndexerOptions& options) {
+    nl_video_analysis::BatchIndexer indexer(config, options);
+    nl_video_analysis::BatchSummary summary = indexer.run(running);
+
+    LOG_INFO("=== Batch Summary ===");
+    LOG_INFO("Files: {} total, {} indexed, {} skipped (checkpoint), {} failed{}", summary.files_total,
+             summary.files_indexed, summary.files_skipped, summary.files_failed,
+             summary.interrupted ? ", interrupted" : "");
+    LOG_INFO("Clips: {} in {:.1f} s ({:.2f} clips/s)", summary.clips, summary.elapsed_seconds, summary.clipsPerSecond());
+    LOG_INFO("Frames: {} decoded ({:.1f} frames/s)", summary.frames, summary.framesPerSecond());
+
+    return (summary.files_failed > 0 || summary.interrupted) ? 1 : 0;
+}
+
 int main(int argc, char* argv[])
 {
     signal(SIGINT, signalHandler);
     signal(SIGTERM, signalHandler);
     
     if (argc < 2) {
-        std::cerr << "Usage: " << argv[0] << " <config.json>" << std::endl;
+        std::cerr << "Usage: " << argv[0] << " <config.json> [--batch <dir> [--checkpoint <file>] [--workers <n>]]" << std::endl;
         std::cerr << "Example: " << argv[0] << " config.json" << std::endl;
+        std::cerr << "Example: " << argv[0] << " config.json --batch /data/archive --workers 8" << std::endl;
         return 1;
     }
 
     std::string config_file = argv[1];
 
+    // Batch mode indexes every video file of a directory as fast as possible and exits; cameras are ignored
+    bool batch_mode = false;
+    nl_video_analysis::BatchIndexerOptions batch_options;
+    for (int i = 2; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--batch") == 0 && i + 1 < argc) {
+            batch_mode = true;
+            batch_options.input_dir = argv[++i];
+        } else if (std::strcmp(argv[i], "--checkpoint") == 0 && i + 1 < argc) {
+            batch_options.checkpoint_path = argv[++i];
+        } else if (std::strcmp(argv[i], "--workers") == 0 && i + 1 < argc) {
+            batch_options.file_workers = std::atoi(argv[++i]);
+        } else {
+            std::cerr << "Unknown argument: " << argv[i] << std::endl;
+            return 1;
+        }
+    }
+
     LOG_INFO("=== Natural Language Vision Analysis System ===");
     LOG_INFO("Loading configuration from: {}", config_file);
 
@@ -40,6 +74,10 @@ int main(int argc, char* argv[])
         return 1;
     }
 
+    if (batch_mode) {
+        return runBatch(config, batch_options);
+    }
+
     if (config.cameras.empty()) {
         LOG_ERROR("No cameras configured");
         return 1;
@@ -48,7 +86,8 @@ int main(int argc, char* argv[])
     nl_video_analysis::VideoAnalysisEngine processor(config);
 
     for (const auto& camera : config.cameras) {
-        if (!processor.addSource(camera.source_url, camera.camera_id, camera.source_type, camera.stream_codec)) {
+        if (!processor.addSource(camera.source_url, camera.camera_id, camera.source_type, camera.stream_codec,
+                                 camera.decode_mode)) {
             LOG_WARN("Failed to add camera: {}", camera.camera_id);
         }
     }